@@ -15,11 +15,13 @@
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/unique_ptr.h>
+#include <nanobind/stl/vector.h>
 
 #include "iCDump/iCDump.hpp"
 
 #include "ObjC.hpp"
 #include "iterator.hpp"
+#include "types_encoding.hpp"
 
 
 namespace nb = nanobind;
@@ -29,16 +31,116 @@ using namespace iCDump::ObjC;
 
 namespace iCDump::py::ObjC {
 
+// RAII wrapper over the buffer protocol (bytes, bytearray, memoryview, ...)
+class py_buffer_t {
+  public:
+  py_buffer_t(nb::handle obj) {
+    if (PyObject_GetBuffer(obj.ptr(), &view_, PyBUF_SIMPLE) != 0) {
+      PyErr_Clear();
+      throw nb::type_error("Expecting a contiguous buffer (bytes, memoryview, ...)");
+    }
+  }
+
+  py_buffer_t(const py_buffer_t&) = delete;
+  py_buffer_t& operator=(const py_buffer_t&) = delete;
+
+  ~py_buffer_t() {
+    PyBuffer_Release(&view_);
+  }
+
+  inline span<const uint8_t> content() const {
+    return {static_cast<const uint8_t*>(view_.buf), static_cast<size_t>(view_.len)};
+  }
+
+  private:
+  Py_buffer view_;
+};
+
+// The buffer remains exported as long as a Metadata references it (through
+// Metadata::storage_). Contrary to keep_alive, the export prevents the
+// content from being resized (bytearray) or released (mmap, memoryview).
+static std::shared_ptr<const py_buffer_t> export_buffer(nb::handle obj) {
+  return {new py_buffer_t(obj), [] (const py_buffer_t* view) {
+    // The last reference can be dropped while the GIL is released
+    nb::gil_scoped_acquire acquire;
+    delete view;
+  }};
+}
+
 void init(nb::module_& m) {
   init_types_encoding(m);
 
-  m.def("parse", iCDump::ObjC::parse,
-        "file_path"_a, "arch"_a = ARCH::AUTO);
+  m.def("parse", nb::overload_cast<const std::string&, ARCH, LOAD_MODE, size_t>(&iCDump::ObjC::parse),
+        "file_path"_a, "arch"_a = ARCH::AUTO, "mode"_a = LOAD_MODE::METADATA_ONLY,
+        "nb_threads"_a = 1);
+
+  m.def("parse",
+        [] (nb::handle buffer, ARCH arch, LOAD_MODE mode, size_t nb_threads) {
+          std::shared_ptr<const py_buffer_t> view = export_buffer(buffer);
+          nb::gil_scoped_release release;
+          return iCDump::ObjC::parse(view->content(), arch, mode, nb_threads, view);
+        },
+        "buffer"_a, "arch"_a = ARCH::AUTO, "mode"_a = LOAD_MODE::METADATA_ONLY,
+        "nb_threads"_a = 1);
+
+  const auto to_dict = [] (slices_metadata_t slices) {
+    nb::dict out;
+    for (auto& [arch, metadata] : slices) {
+      out[nb::cast(arch)] = nb::cast(metadata.release(), nb::rv_policy::take_ownership);
+    }
+    return out;
+  };
+
+  m.def("parse_all",
+        [to_dict] (const std::string& file_path, LOAD_MODE mode, size_t nb_threads) {
+          slices_metadata_t slices;
+          {
+            nb::gil_scoped_release release;
+            slices = iCDump::ObjC::parse_all(file_path, mode, nb_threads);
+          }
+          return to_dict(std::move(slices));
+        },
+        "file_path"_a, "mode"_a = LOAD_MODE::METADATA_ONLY, "nb_threads"_a = 0);
+
+  m.def("parse_all",
+        [to_dict] (nb::handle buffer, LOAD_MODE mode, size_t nb_threads) {
+          std::shared_ptr<const py_buffer_t> view = export_buffer(buffer);
+          slices_metadata_t slices;
+          {
+            nb::gil_scoped_release release;
+            slices = iCDump::ObjC::parse_all(view->content(), mode, nb_threads, view);
+          }
+          return to_dict(std::move(slices));
+        },
+        "buffer"_a, "mode"_a = LOAD_MODE::METADATA_ONLY, "nb_threads"_a = 0);
+
+  m.def("parse_ipa",
+        [] (const std::string& ipa_path, ARCH arch, LOAD_MODE mode, size_t nb_threads) {
+          ipa_metadata_t bundle;
+          {
+            nb::gil_scoped_release release;
+            bundle = iCDump::ObjC::parse_ipa(ipa_path, arch, mode, nb_threads);
+          }
+          nb::dict out;
+          for (auto& [path, metadata] : bundle) {
+            out[nb::cast(path)] = nb::cast(metadata.release(), nb::rv_policy::take_ownership);
+          }
+          return out;
+        },
+        "ipa_path"_a, "arch"_a = ARCH::AUTO, "mode"_a = LOAD_MODE::METADATA_ONLY,
+        "nb_threads"_a = 0);
 
   nb::class_<IVar>(m, "IVar")
-    .def_property_readonly("name", &IVar::name)
-    .def_property_readonly("mangled_type", &IVar::mangled_type)
-    .def_property_readonly("type", &IVar::type, nb::rv_policy::take_ownership)
+    .def_property_readonly("name",
+        [] (const IVar& self) {
+          return std::string(self.name());
+        })
+    .def_property_readonly("mangled_type",
+        [] (const IVar& self) {
+          return std::string(self.mangled_type());
+        })
+    // Owned (and shared) by the TypeCache of the Metadata
+    .def_property_readonly("type", &IVar::type, nb::rv_policy::reference_internal)
     .def("to_decl",
          &IVar::to_decl)
 
@@ -48,8 +150,14 @@ void init(nb::module_& m) {
          });
 
   nb::class_<Property>(m, "Property")
-    .def_property_readonly("name", &Property::name)
-    .def_property_readonly("attribute", &Property::attribute)
+    .def_property_readonly("name",
+        [] (const Property& self) {
+          return std::string(self.name());
+        })
+    .def_property_readonly("attribute",
+        [] (const Property& self) {
+          return std::string(self.attribute());
+        })
     .def("to_decl",
          &Property::to_decl)
 
@@ -59,13 +167,31 @@ void init(nb::module_& m) {
          });
 
   nb::class_<Method> meth(m, "Method");
-  nb::class_<Method::prototype_t>(meth, "prototype_t");
+  nb::class_<Method::prototype_t> prototype(meth, "prototype_t");
+  init_iterator<Method::params_it_t>(prototype, "params_it_t");
+  // The types are shared by the TypeCache of the Metadata: they are
+  // returned as references instead of copies
+  prototype
+    .def_property_readonly("rtype",
+        [] (const Method::prototype_t& self) {
+          return self.rtype;
+        }, nb::rv_policy::reference_internal)
+    .def_property_readonly("params",
+        [] (const Method::prototype_t& self) {
+          return Method::params_it_t{self.params};
+        }, nb::rv_policy::move);
   meth
-    .def_property_readonly("name", &Method::name)
-    .def_property_readonly("mangled_type", &Method::mangled_type)
+    .def_property_readonly("name",
+        [] (const Method& self) {
+          return std::string(self.name());
+        })
+    .def_property_readonly("mangled_type",
+        [] (const Method& self) {
+          return std::string(self.mangled_type());
+        })
     .def_property_readonly("address", &Method::address)
     .def_property_readonly("is_instance", &Method::is_instance)
-    .def_property_readonly("prototype", &Method::prototype, nb::rv_policy::move)
+    .def_property_readonly("prototype", &Method::prototype, nb::rv_policy::reference_internal)
     .def("__str__",
          [] (const Method& self) {
           return self.to_string();
@@ -73,10 +199,15 @@ void init(nb::module_& m) {
 
 
   nb::class_<Protocol> protocol(m, "Protocol");
+  init_iterator<Protocol::protocols_it_t>(protocol, "protocols_it_t");
   init_iterator<Protocol::methods_it_t>(protocol, "methods_it_t");
   init_iterator<Protocol::properties_it_t>(protocol, "properties_it_t");
   protocol
-    .def_property_readonly("mangled_name", &Protocol::mangled_name)
+    .def_property_readonly("mangled_name",
+        [] (const Protocol& self) {
+          return std::string(self.mangled_name());
+        })
+    .def_property_readonly("protocols", &Protocol::protocols, nb::rv_policy::move)
     .def_property_readonly("optional_methods", &Protocol::optional_methods, nb::rv_policy::move)
     .def_property_readonly("required_methods", &Protocol::required_methods, nb::rv_policy::move)
     .def_property_readonly("properties", &Protocol::properties, nb::rv_policy::move)
@@ -90,14 +221,21 @@ void init(nb::module_& m) {
 
   nb::class_<Class> cls(m, "Class");
   /*
-   * methods_it_t and properties_it_t are already registered with the Protocol class
+   * protocols_it_t, methods_it_t and properties_it_t are already registered with the Protocol class
    */
-  init_iterator<Class::protocols_it_t>(cls, "protocols_it_t");
   init_iterator<Class::ivars_it_t>(cls, "ivars_it_t");
 
   cls
-    .def_property_readonly("name", &Class::name)
-    .def_property_readonly("super_class", &Class::super_class)
+    .def_property_readonly("name",
+        [] (const Class& self) {
+          return std::string(self.name());
+        })
+    .def_property_readonly("super_class", &Class::super_class, nb::rv_policy::reference_internal)
+    .def_property_readonly("super_class_name",
+        [] (const Class& self) {
+          return std::string(self.super_class_name());
+        })
+    .def_property_readonly("meta_class", &Class::meta_class, nb::rv_policy::reference_internal)
     .def_property_readonly("demangled_name", &Class::demangled_name)
     .def_property_readonly("is_meta", &Class::is_meta)
     .def_property_readonly("methods", &Class::methods, nb::rv_policy::move)
@@ -112,15 +250,175 @@ void init(nb::module_& m) {
           return self.to_string();
          });
 
+  nb::class_<ClassHandle>(m, "ClassHandle")
+    .def_property_readonly("address", &ClassHandle::address)
+    .def_property_readonly("name",
+        [] (const ClassHandle& self) {
+          return std::string(self.name());
+        })
+    .def_property_readonly("is_resolved", &ClassHandle::is_resolved)
+    .def("get", &ClassHandle::get, nb::rv_policy::reference_internal)
+
+    .def("__str__",
+         [] (const ClassHandle& self) {
+          return std::string(self.name());
+         });
+
+  nb::class_<Category>(m, "Category")
+    .def_property_readonly("name",
+        [] (const Category& self) {
+          return std::string(self.name());
+        })
+    .def_property_readonly("class_name",
+        [] (const Category& self) {
+          return std::string(self.class_name());
+        })
+    .def_property_readonly("target", &Category::target, nb::rv_policy::reference_internal)
+    .def_property_readonly("instance_methods", &Category::instance_methods, nb::rv_policy::move)
+    .def_property_readonly("class_methods", &Category::class_methods, nb::rv_policy::move)
+    .def_property_readonly("protocols", &Category::protocols, nb::rv_policy::move)
+    .def_property_readonly("properties", &Category::properties, nb::rv_policy::move)
+
+    .def("__str__",
+         [] (const Category& self) {
+          return self.to_string();
+         });
+
+  nb::class_<MethodStore> store(m, "MethodStore");
+  store.attr("INSTANCE") = static_cast<int>(MethodStore::INSTANCE);
+  store.attr("OPTIONAL") = static_cast<int>(MethodStore::OPTIONAL);
+  store.attr("PROTOCOL") = static_cast<int>(MethodStore::PROTOCOL);
+  store.attr("CATEGORY") = static_cast<int>(MethodStore::CATEGORY);
+  store.attr("NO_ID")    = MethodStore::NO_ID;
+  store.attr("NO_OWNER") = MethodStore::NO_OWNER;
+
+  // The columns are returned as copies (list)
+  store
+    .def_property_readonly("selectors", &MethodStore::selectors)
+    .def_property_readonly("types", &MethodStore::types)
+    .def_property_readonly("imps", &MethodStore::imps)
+    .def_property_readonly("owners", &MethodStore::owners)
+    .def_property_readonly("flags", &MethodStore::flags)
+    .def("string",
+         [] (const MethodStore& self, MethodStore::id_t id) {
+          if (id >= self.nb_strings()) {
+            throw nb::index_error("Invalid string id");
+          }
+          return std::string(self.string(id));
+         }, "id"_a)
+    .def("find",
+         [] (const MethodStore& self, const std::string& str) {
+          return self.find(str);
+         }, "string"_a)
+    .def("__len__", &MethodStore::size);
+
+  nb::class_<ImpIndex> imp_index(m, "ImpIndex");
+  imp_index.attr("NOT_FOUND") = ImpIndex::NOT_FOUND;
+  imp_index
+    .def_property_readonly("starts", &ImpIndex::starts)
+    .def_property_readonly("ends", &ImpIndex::ends)
+    .def("method", &ImpIndex::method, "idx"_a, nb::rv_policy::reference_internal)
+    .def("owner", &ImpIndex::owner, "idx"_a, nb::rv_policy::reference_internal)
+    .def("category", &ImpIndex::category, "idx"_a, nb::rv_policy::reference_internal)
+    .def("symbol", &ImpIndex::symbol, "idx"_a)
+    .def("lookup",
+         [] (const ImpIndex& self, uint64_t address) {
+          return self.lookup(address);
+         }, "address"_a)
+    .def("lookup",
+         [] (const ImpIndex& self, const std::vector<uint64_t>& addresses) {
+          nb::gil_scoped_release release;
+          return self.lookup(addresses);
+         }, "addresses"_a)
+    .def("symbolicate",
+         [] (const ImpIndex& self, const std::vector<uint64_t>& addresses) {
+          std::vector<uint32_t> indexes;
+          {
+            nb::gil_scoped_release release;
+            indexes = self.lookup(addresses);
+          }
+          nb::list out;
+          for (uint32_t idx : indexes) {
+            out.append(idx == ImpIndex::NOT_FOUND ? nb::none() : nb::cast(self.symbol(idx)));
+          }
+          return out;
+         }, "addresses"_a)
+    .def("__len__", &ImpIndex::size);
+
+  nb::class_<SelectorIndex>(m, "SelectorIndex")
+    .def("find",
+         [] (const SelectorIndex& self, const std::string& selector) {
+          SelectorIndex::postings_t rows = self.find(selector);
+          return std::vector<uint32_t>(rows.begin(), rows.end());
+         }, "selector"_a,
+         "Rows of the MethodStore with the given selector")
+    .def("prefix",
+         [] (const SelectorIndex& self, const std::string& prefix) {
+          std::vector<std::string> selectors;
+          for (SelectorIndex::id_t id : self.prefix(prefix)) {
+            selectors.emplace_back(self.selector(id));
+          }
+          return selectors;
+         }, "prefix"_a)
+    .def("__len__", &SelectorIndex::size);
+
   nb::class_<Metadata> metadata(m, "Metadata");
+  /*
+   * protocol_it_t is the same type as Protocol.protocols_it_t
+   */
   init_iterator<Metadata::classes_it_t>(metadata, "classes_it_t");
-  init_iterator<Metadata::protocol_it_t>(metadata, "protocol_it_t");
+  init_iterator<Metadata::categories_it_t>(metadata, "categories_it_t");
+  init_iterator<Metadata::class_handles_it_t>(metadata, "class_handles_it_t");
 
   metadata
     .def_property_readonly("classes",
         &Metadata::classes, nb::rv_policy::move)
     .def_property_readonly("protocols",
         &Metadata::protocols, nb::rv_policy::move)
+    .def_property_readonly("categories",
+        &Metadata::categories, nb::rv_policy::move)
+    .def_property_readonly("class_handles",
+        &Metadata::class_handles, nb::rv_policy::move)
+    .def_property_readonly("is_lazy", &Metadata::is_lazy)
+    .def("get_class", &Metadata::get_class, "name"_a, nb::rv_policy::reference_internal)
+    .def("get_protocol", &Metadata::get_protocol, "name"_a, nb::rv_policy::reference_internal)
+    .def_property_readonly("class_refs",
+        [] (const Metadata& self) {
+          return std::vector<std::string>(self.class_refs().begin(), self.class_refs().end());
+        })
+    .def_property_readonly("method_store",
+        &Metadata::method_store, nb::rv_policy::reference_internal)
+    .def_property_readonly("imp_index",
+        &Metadata::imp_index, nb::rv_policy::reference_internal)
+    .def_property_readonly("selector_index",
+        &Metadata::selector_index, nb::rv_policy::reference_internal)
+
+    // (owner name, MethodStore flags) of the methods with the given
+    // selector. The owner name is None for the unlisted classes.
+    .def("implementors",
+         [] (const Metadata& self, const std::string& selector) {
+          const MethodStore& store = self.method_store();
+          Metadata::classes_it_t classes = self.classes();
+          Metadata::protocol_it_t protocols = self.protocols();
+          Metadata::categories_it_t categories = self.categories();
+          nb::list out;
+          for (uint32_t row : self.selector_index().find(selector)) {
+            const uint32_t owner = store.owners()[row];
+            const uint8_t flags  = store.flags()[row];
+            nb::object name = nb::none();
+            if (owner != MethodStore::NO_OWNER) {
+              if (flags & MethodStore::PROTOCOL) {
+                name = nb::cast(std::string(protocols[owner].mangled_name()));
+              } else if (flags & MethodStore::CATEGORY) {
+                name = nb::cast(categories[owner].to_string());
+              } else {
+                name = nb::cast(std::string(classes[owner].name()));
+              }
+            }
+            out.append(nb::make_tuple(name, flags));
+          }
+          return out;
+         }, "selector"_a)
     .def("to_decl", &Metadata::to_decl);
 }
 
@@ -23,60 +23,12 @@
 
 #include "ObjC.hpp"
 #include "iterator.hpp"
+#include "types_encoding.hpp"
 
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
-NAMESPACE_BEGIN(NB_NAMESPACE)
-NAMESPACE_BEGIN(detail)
-template <> struct type_caster<iCDump::ObjC::Type> {
-  NB_TYPE_CASTER(iCDump::ObjC::Type, const_name("Type"));
-
-  bool from_python(handle src, uint8_t flags, cleanup_list* cl) noexcept {
-    // TODO(romain)
-    return false;
-  }
-
-  static handle from_cpp(iCDump::ObjC::Type& Ty, rv_policy rvp,
-                         cleanup_list* cl) noexcept {
-    using namespace iCDump::ObjC;
-
-    if (iCDump::ObjC::PrimitiveTy::classof(Ty)) {
-      return nb::detail::make_caster<iCDump::ObjC::PrimitiveTy>::from_cpp(&Ty, rvp, cl);
-    }
-
-    switch (Ty.type) {
-      case OBJC_TYPES::SELECTOR:
-        return nb::detail::make_caster<iCDump::ObjC::SelectorTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::UNKNOWN:
-        return nb::detail::make_caster<iCDump::ObjC::UnknownTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::CLASS:
-        return nb::detail::make_caster<iCDump::ObjC::ClassTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::BLOCK:
-        return nb::detail::make_caster<iCDump::ObjC::BlockTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::OBJECT:
-        return nb::detail::make_caster<iCDump::ObjC::ObjectTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::POINTER:
-        return nb::detail::make_caster<iCDump::ObjC::PointerTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::ARRAY:
-        return nb::detail::make_caster<iCDump::ObjC::ArrayTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::STRUCT:
-        return nb::detail::make_caster<iCDump::ObjC::StructTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::UNION:
-        return nb::detail::make_caster<iCDump::ObjC::UnionTy>::from_cpp(&Ty, rvp, cl);
-      case OBJC_TYPES::BIT_FIELD:
-        return nb::detail::make_caster<iCDump::ObjC::BitFieldTy>::from_cpp(&Ty, rvp, cl);
-      default:
-        return nb::none().release();
-    }
-
-    return nb::none().release();
-  }
-};
-NAMESPACE_END(detail)
-NAMESPACE_END(NB_NAMESPACE)
-
 using namespace iCDump::ObjC;
 
 namespace iCDump::py::ObjC {
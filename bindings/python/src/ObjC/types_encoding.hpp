@@ -0,0 +1,70 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PY_ICDUMP_OBJC_TYPES_ENCODING_H
+#define PY_ICDUMP_OBJC_TYPES_ENCODING_H
+#include <nanobind/nanobind.h>
+
+#include "iCDump/ObjC/TypesEncoding.hpp"
+
+// Cast a Type into its Python subclass (PrimitiveTy, StructTy, ...)
+NAMESPACE_BEGIN(NB_NAMESPACE)
+NAMESPACE_BEGIN(detail)
+template <> struct type_caster<iCDump::ObjC::Type> {
+  NB_TYPE_CASTER(iCDump::ObjC::Type, const_name("Type"));
+
+  bool from_python(handle src, uint8_t flags, cleanup_list* cl) noexcept {
+    // TODO(romain)
+    return false;
+  }
+
+  static handle from_cpp(const iCDump::ObjC::Type& Ty, rv_policy rvp,
+                         cleanup_list* cl) noexcept {
+    using namespace iCDump::ObjC;
+
+    if (iCDump::ObjC::PrimitiveTy::classof(Ty)) {
+      return nanobind::detail::make_caster<iCDump::ObjC::PrimitiveTy>::from_cpp(&Ty, rvp, cl);
+    }
+
+    switch (Ty.type) {
+      case OBJC_TYPES::SELECTOR:
+        return nanobind::detail::make_caster<iCDump::ObjC::SelectorTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::UNKNOWN:
+        return nanobind::detail::make_caster<iCDump::ObjC::UnknownTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::CLASS:
+        return nanobind::detail::make_caster<iCDump::ObjC::ClassTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::BLOCK:
+        return nanobind::detail::make_caster<iCDump::ObjC::BlockTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::OBJECT:
+        return nanobind::detail::make_caster<iCDump::ObjC::ObjectTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::POINTER:
+        return nanobind::detail::make_caster<iCDump::ObjC::PointerTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::ARRAY:
+        return nanobind::detail::make_caster<iCDump::ObjC::ArrayTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::STRUCT:
+        return nanobind::detail::make_caster<iCDump::ObjC::StructTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::UNION:
+        return nanobind::detail::make_caster<iCDump::ObjC::UnionTy>::from_cpp(&Ty, rvp, cl);
+      case OBJC_TYPES::BIT_FIELD:
+        return nanobind::detail::make_caster<iCDump::ObjC::BitFieldTy>::from_cpp(&Ty, rvp, cl);
+      default:
+        return nanobind::none().release();
+    }
+
+    return nanobind::none().release();
+  }
+};
+NAMESPACE_END(detail)
+NAMESPACE_END(NB_NAMESPACE)
+#endif
@@ -43,7 +43,13 @@ NB_MODULE(icdump, m) {
     .value("AARCH64", ARCH::AARCH64)
     .value("ARM",     ARCH::ARM)
     .value("X86_64",  ARCH::X86_64)
-    .value("X86",     ARCH::X86);
+    .value("X86",     ARCH::X86)
+    .value("AARCH64E", ARCH::AARCH64E);
+
+  nb::enum_<LOAD_MODE>(m, "LOAD_MODE")
+    .value("METADATA_ONLY", LOAD_MODE::METADATA_ONLY)
+    .value("FULL",          LOAD_MODE::FULL)
+    .value("LAZY",          LOAD_MODE::LAZY);
 
   m.def("disable_log", &disable_log);
   m.def("enable_log", &enable_log);
@@ -8,13 +8,14 @@ from pathlib import Path
 from typing import Optional
 
 def process(filepath: str, skip_protocols: bool = False,
-            output_path: Optional[str] = None) -> int:
+            output_path: Optional[str] = None,
+            mode: icdump.LOAD_MODE = icdump.LOAD_MODE.METADATA_ONLY) -> int:
     target = Path(filepath)
     if not target.is_file():
         print(f"'{target}' is not a valid file", file=sys.stderr)
         return 1
 
-    metadata = icdump.objc.parse(target.as_posix())
+    metadata = icdump.objc.parse(target.as_posix(), mode=mode)
     if metadata is None:
         print(f"Can't parse ObjC metadata in {target}'", file=sys.stderr)
         return 1
@@ -51,6 +52,9 @@ def main() -> int:
     parser.add_argument('--skip-protocols',
                         help='Skip ObjC protocols definition',
                         action='store_true')
+    parser.add_argument('--full-load',
+                        help='Fully parse the Mach-O file with LIEF (slower)',
+                        action='store_true')
     parser.add_argument("file", help='Mach-O file')
 
     logger_group = parser.add_argument_group('Logger')
@@ -91,7 +95,8 @@ def main() -> int:
 
     icdump.set_log_level(args.main_verbosity)
 
-    return process(args.file, args.skip_protocols, args.output)
+    mode = icdump.LOAD_MODE.FULL if args.full_load else icdump.LOAD_MODE.METADATA_ONLY
+    return process(args.file, args.skip_protocols, args.output, mode)
 
 if __name__ == "__main__":
     sys.exit(main())
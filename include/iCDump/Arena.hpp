@@ -0,0 +1,112 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_ARENA_H_
+#define ICDUMP_ARENA_H_
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "iCDump/NonCopyable.hpp"
+#include "iCDump/span.hpp"
+
+namespace iCDump {
+
+//! Bump allocator which owns the objects and the strings allocated in it.
+//!
+//! Memory is only released when the arena is destroyed or reset. The
+//! destructors of the objects which are not trivially destructible are
+//! called (in the reverse order of their creation) at this point.
+//! An Arena is not thread-safe.
+class Arena : protected NonCopyable {
+  public:
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  Arena() = default;
+  ~Arena();
+
+  inline void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+    const auto addr = reinterpret_cast<uintptr_t>(cursor_);
+    const uintptr_t aligned = (addr + align - 1) & ~(align - 1);
+    if (cursor_ != nullptr && aligned + size <= reinterpret_cast<uintptr_t>(end_)) {
+      cursor_ = reinterpret_cast<uint8_t*>(aligned + size);
+      return reinterpret_cast<void*>(aligned);
+    }
+    return allocate_slow(size, align);
+  }
+
+  template<class T, class... Args>
+  T* make(Args&&... args) {
+    T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      void* raw = allocate(sizeof(dtor_t), alignof(dtor_t));
+      dtors_ = new (raw) dtor_t{&destroy<T>, obj, dtors_};
+    }
+    return obj;
+  }
+
+  //! Copy the given string (with a NUL terminator) in the arena
+  std::string_view copy(std::string_view str);
+
+  //! Copy the given (trivially copyable) values in the arena
+  template<class T>
+  span<const T> copy(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (values.empty()) {
+      return {};
+    }
+    auto* data = static_cast<T*>(allocate(values.size() * sizeof(T), alignof(T)));
+    std::copy(values.begin(), values.end(), data);
+    return {data, values.size()};
+  }
+
+  //! Destroy the objects allocated so far. The current block is kept
+  //! to serve the next allocations (e.g. to decode another encoding
+  //! with decode_nodes()).
+  void reset();
+
+  //! Number of bytes reserved by the arena
+  inline size_t reserved() const {
+    return reserved_;
+  }
+
+  private:
+  //! Allocate a new block (or a dedicated one for a large allocation)
+  void* allocate_slow(size_t size, size_t align);
+
+  struct dtor_t {
+    void (*func)(void*);
+    void* obj;
+    dtor_t* next;
+  };
+
+  template<class T>
+  static void destroy(void* obj) {
+    static_cast<T*>(obj)->~T();
+  }
+
+  std::vector<std::unique_ptr<uint8_t[]>> blocks_;
+  uint8_t* cursor_ = nullptr;
+  uint8_t* end_    = nullptr;
+  dtor_t* dtors_   = nullptr;
+  size_t reserved_ = 0;
+};
+}
+#endif
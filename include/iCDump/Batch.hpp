@@ -0,0 +1,89 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_BATCH_H_
+#define ICDUMP_BATCH_H_
+#include <iCDump/iCDump.hpp>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace iCDump::ObjC {
+
+struct batch_config_t {
+  //! Directory where the ``<name>_objc.h`` outputs are written. The layout
+  //! of the input directories is preserved. If empty, only the metadata are
+  //! parsed (no declaration is generated).
+  std::string output_dir;
+
+  ARCH arch      = ARCH::AUTO;
+  LOAD_MODE mode = LOAD_MODE::METADATA_ONLY;
+
+  //! Only output the classes
+  bool skip_protocols = false;
+
+  //! If 0, the number of hardware threads is used
+  size_t nb_threads = 0;
+
+  //! Maximum number of binaries processed or queued at the same time.
+  //! If 0, twice the number of threads
+  size_t max_inflight = 0;
+};
+
+struct batch_entry_t {
+  enum class STATUS {
+    OK = 0,
+    NOT_MACHO,
+    ERROR,
+  };
+
+  std::string path;
+  std::string output_path;
+  STATUS status = STATUS::ERROR;
+  uint64_t size       = 0;
+  size_t nb_classes   = 0;
+  size_t nb_protocols = 0;
+  std::chrono::milliseconds elapsed{0};
+};
+
+struct batch_summary_t {
+  //! Entries in the order of the inputs (directories are expanded)
+  std::vector<batch_entry_t> entries;
+  size_t nb_success  = 0;
+  size_t nb_skipped  = 0;
+  size_t nb_failed   = 0;
+  uint64_t nb_bytes  = 0;
+  std::chrono::milliseconds elapsed{0};
+
+  std::string to_string() const;
+};
+
+//! Called from the worker threads once an entry is processed
+using batch_callback_t = std::function<void(const batch_entry_t&)>;
+
+//! Dump the ObjC metadata of a corpus of files and directories (recursively)
+//! on a work-stealing thread pool.
+//!
+//! The files are dispatched by alternating the largest and the smallest ones
+//! so that large binaries are started early without holding back the small
+//! ones, and at most ``max_inflight`` binaries are alive at the same time.
+batch_summary_t dump_batch(const std::vector<std::string>& inputs,
+                           const batch_config_t& config = {},
+                           const batch_callback_t& callback = nullptr);
+}
+
+#endif
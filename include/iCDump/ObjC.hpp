@@ -14,12 +14,20 @@
  */
 #ifndef ICDUMP_OBJC_H_
 #define ICDUMP_OBJC_H_
+#include <iCDump/ObjC/Category.hpp>
 #include <iCDump/ObjC/Class.hpp>
+#include <iCDump/ObjC/ClassHandle.hpp>
+#include <iCDump/ObjC/ImpIndex.hpp>
 #include <iCDump/ObjC/Metadata.hpp>
 #include <iCDump/ObjC/Method.hpp>
+#include <iCDump/ObjC/MethodStore.hpp>
 #include <iCDump/ObjC/Parser.hpp>
 #include <iCDump/ObjC/Protocol.hpp>
 #include <iCDump/ObjC/Property.hpp>
+#include <iCDump/ObjC/SelectorIndex.hpp>
 #include <iCDump/ObjC/IVar.hpp>
+#include <iCDump/ObjC/TypeCache.hpp>
+#include <iCDump/ObjC/TypeNode.hpp>
+#include <iCDump/ObjC/TypeVisitor.hpp>
 #include <iCDump/ObjC/TypesEncoding.hpp>
 #endif
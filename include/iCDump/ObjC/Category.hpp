@@ -0,0 +1,87 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_CATEGORY_H_
+#define ICDUMP_OBJC_CATEGORY_H_
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "iCDump/iterators.hpp"
+#include "iCDump/span.hpp"
+
+namespace iCDump::ObjC {
+class Class;
+class Method;
+class Parser;
+class Property;
+class Protocol;
+
+//! Mirror of category_t
+//!
+//! The methods, the protocols and the properties of a category which
+//! extends a class of the image are also attached to this class
+//! (and its metaclass for the class methods).
+class Category {
+  public:
+  friend class Parser;
+  using methods_t    = span<Method* const>;
+  using protocols_t  = std::vector<Protocol*>;
+  using properties_t = std::vector<Property*>;
+
+  using methods_it_t    = const_ref_iterator<methods_t>;
+  using protocols_it_t  = const_ref_iterator<const protocols_t&>;
+  using properties_it_t = const_ref_iterator<const properties_t&>;
+
+  Category() = default;
+  Category(const Category&) = delete;
+  Category& operator=(const Category&) = delete;
+
+  static Category* create(Parser& parser, uintptr_t address);
+
+  inline std::string_view name() const {
+    return name_;
+  }
+
+  //! Name of the extended class. For a class defined in another image,
+  //! it is resolved from the binding of category_t.cls.
+  inline std::string_view class_name() const {
+    return class_name_;
+  }
+
+  //! Extended class if it is defined in this image
+  inline const Class* target() const {
+    return target_;
+  }
+
+  inline methods_it_t instance_methods() const { return instance_methods_; }
+  inline methods_it_t class_methods() const { return class_methods_; }
+  inline protocols_it_t protocols() const { return protocols_; }
+  inline properties_it_t properties() const { return properties_; }
+
+  std::string to_string() const;
+
+  private:
+  std::string_view name_;
+  std::string_view class_name_;
+  Class* target_ = nullptr;
+
+  methods_t    instance_methods_;
+  methods_t    class_methods_;
+  protocols_t  protocols_;
+  properties_t properties_;
+};
+
+}
+#endif
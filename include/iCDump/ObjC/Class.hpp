@@ -15,14 +15,12 @@
 #ifndef ICDUMP_OBJCCLASS_H_
 #define ICDUMP_OBJCCLASS_H_
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
 #include "iCDump/iterators.hpp"
-
-namespace LIEF {
-class BinaryStream;
-}
+#include "iCDump/span.hpp"
 
 namespace iCDump::ObjC {
 class Protocol;
@@ -34,6 +32,7 @@ class IVar;
 //! Mirror of class_ro_t
 class Class {
   public:
+  friend class Parser;
   static constexpr auto META                       = 1 << 0;
   static constexpr auto ROOT                       = 1 << 1;
   static constexpr auto HAS_CXX_STRUCTORS          = 1 << 2;
@@ -46,27 +45,40 @@ class Class {
   static constexpr auto FORBIDS_ASSOCIATED_OBJECTS = 1 << 10;
 
   using protocols_t     = std::vector<Protocol*>;
-  using methods_t       = std::vector<std::unique_ptr<Method>>;
-  using properties_t    = std::vector<std::unique_ptr<Property>>;
-  using ivars_t         = std::vector<std::unique_ptr<IVar>>;
+  //! View over the rows of the Metadata's MethodStore
+  using methods_t       = span<Method* const>;
+  using properties_t    = std::vector<Property*>;
+  using ivars_t         = std::vector<IVar*>;
 
-  using methods_it_t    = const_ref_iterator<const methods_t&, Method*>;
-  using ivars_it_t      = const_ref_iterator<const ivars_t&, IVar*>;
+  using methods_it_t    = const_ref_iterator<methods_t>;
+  using ivars_it_t      = const_ref_iterator<const ivars_t&>;
   using protocols_it_t  = const_ref_iterator<const protocols_t&>;
-  using properties_it_t = const_ref_iterator<const properties_t&, Property*>;
+  using properties_it_t = const_ref_iterator<const properties_t&>;
 
   Class();
   Class(const Class&) = delete;
   Class& operator=(const Class&) = delete;
 
-  static std::unique_ptr<Class> create(Parser& parser);
+  static Class* create(Parser& parser, uintptr_t address);
 
-  inline const std::string& name() const {
+  inline std::string_view name() const {
     return name_;
   }
 
+  //! Superclass if it is defined in this image
   inline const Class* super_class() const {
-    return super_.get();
+    return super_;
+  }
+
+  //! Name of the superclass, including the classes imported from
+  //! another image (e.g. ``NSObject``)
+  inline std::string_view super_class_name() const {
+    return super_ != nullptr ? super_->name_ : super_name_;
+  }
+
+  //! Class referenced by the isa pointer (i.e. the metaclass for a regular class)
+  inline const Class* meta_class() const {
+    return meta_;
   }
 
   std::string demangled_name() const;
@@ -81,13 +93,19 @@ class Class {
   inline ivars_it_t ivars() const { return ivars_; }
 
   std::string to_string() const;
+
+  //! Objective-C declaration of the class, generated with clang.
+  //! It can be called from several threads: each calling thread lazily
+  //! creates (and keeps) its own clang context.
   std::string to_decl() const;
 
   private:
-  std::unique_ptr<Class> super_;
+  Class* super_ = nullptr;
+  Class* meta_  = nullptr;
+  std::string_view super_name_;
 
   uint32_t    flags_ = 0;
-  std::string name_;
+  std::string_view name_;
   uint32_t    instance_start_ = 0;
   uint32_t    instance_size_ = 0;
   uint32_t    reserved_ = 0;
@@ -0,0 +1,67 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_CLASS_HANDLE_H_
+#define ICDUMP_OBJC_CLASS_HANDLE_H_
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+namespace iCDump::ObjC {
+class Class;
+class Parser;
+
+//! Lightweight reference to a class of __objc_classlist.
+//!
+//! With LOAD_MODE::LAZY, only the name of the class is decoded when the
+//! Metadata is created: its methods, ivars, properties, ... are decoded on
+//! the first call to get(). Otherwise, the class is already decoded.
+class ClassHandle {
+  public:
+  friend class Parser;
+
+  ClassHandle() = default;
+  ClassHandle(const ClassHandle&) = delete;
+  ClassHandle& operator=(const ClassHandle&) = delete;
+
+  //! Address of the objc_class_t
+  inline uintptr_t address() const {
+    return address_;
+  }
+
+  inline std::string_view name() const {
+    return name_;
+  }
+
+  //! Check if the class has already been decoded
+  bool is_resolved() const;
+
+  //! Decode the class on the first call and return the cached class on the
+  //! next ones (nullptr if it can't be decoded). This function is thread-safe.
+  const Class* get() const;
+
+  private:
+  uintptr_t address_ = 0;
+  std::string_view name_;
+
+  //! Parser of the lazy Metadata (null if the class is decoded eagerly)
+  Parser* parser_ = nullptr;
+  mutable std::once_flag once_;
+  mutable std::atomic<bool> resolved_{false};
+  mutable const Class* cls_ = nullptr;
+};
+
+}
+#endif
@@ -15,10 +15,12 @@
 #ifndef ICDUMP_IVAR_H_
 #define ICDUMP_IVAR_H_
 #include <string>
+#include <string_view>
 #include <memory>
 
 namespace iCDump::ObjC {
 class Parser;
+class TypeCache;
 struct Type;
 
 class IVar {
@@ -26,24 +28,26 @@ class IVar {
   friend class Parser;
 
   IVar() = default;
-  static std::unique_ptr<IVar> create(Parser& parser);
+  static IVar* create(const Parser& parser, uintptr_t address);
 
-  inline const std::string& name() const {
+  inline std::string_view name() const {
     return name_;
   }
 
-  inline const std::string& mangled_type() const {
+  inline std::string_view mangled_type() const {
     return mangled_type_;
   }
 
-  std::unique_ptr<Type> type() const;
+  //! Decoded type (owned by the TypeCache of the Metadata)
+  const Type* type() const;
 
   std::string to_string() const;
   std::string to_decl() const;
 
   private:
-  std::string name_;
-  std::string mangled_type_;
+  std::string_view name_;
+  std::string_view mangled_type_;
+  TypeCache* type_cache_ = nullptr;
 };
 
 }
@@ -0,0 +1,96 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_IMP_INDEX_H_
+#define ICDUMP_OBJC_IMP_INDEX_H_
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "iCDump/span.hpp"
+
+namespace iCDump::ObjC {
+class Category;
+class Class;
+class Method;
+class Parser;
+
+//! Immutable index of the method implementations sorted by address.
+//!
+//! Each entry covers [start, end) where ``end`` is the next function
+//! start (LC_FUNCTION_STARTS) or, if not available, the next IMP.
+//! It is used to resolve the method which contains a given address
+//! (e.g. the frames of a crash report).
+class ImpIndex {
+  public:
+  friend class Parser;
+  static constexpr uint32_t NOT_FOUND = static_cast<uint32_t>(-1);
+
+  ImpIndex() = default;
+  ImpIndex(const ImpIndex&) = delete;
+  ImpIndex& operator=(const ImpIndex&) = delete;
+
+  inline size_t size() const {
+    return starts_.size();
+  }
+
+  inline const std::vector<uint64_t>& starts() const {
+    return starts_;
+  }
+
+  inline const std::vector<uint64_t>& ends() const {
+    return ends_;
+  }
+
+  inline const Method& method(uint32_t idx) const {
+    return *methods_[idx];
+  }
+
+  //! Class (or metaclass for a class method) which implements the method.
+  //! It is null for the categories of a class defined in another image.
+  inline const Class* owner(uint32_t idx) const {
+    return classes_[idx];
+  }
+
+  //! Category which provides the method (if any)
+  inline const Category* category(uint32_t idx) const {
+    return categories_[idx];
+  }
+
+  //! Index of the entry which contains the given address or NOT_FOUND
+  uint32_t lookup(uint64_t address) const;
+
+  //! Resolve all the given addresses (``out`` must have the same size).
+  //! Sorted inputs are resolved in a single linear pass.
+  void lookup(span<const uint64_t> addresses, span<uint32_t> out) const;
+
+  std::vector<uint32_t> lookup(span<const uint64_t> addresses) const;
+
+  //! Symbol of the entry in the ObjC format: ``-[Class selector]``
+  //! or ``-[Class(Category) selector]``
+  std::string symbol(uint32_t idx) const;
+
+  private:
+  //! Sort the entries and compute their extents
+  void finalize(const std::vector<uint64_t>& function_starts, uint64_t limit);
+
+  std::vector<uint64_t> starts_;
+  std::vector<uint64_t> ends_;
+  std::vector<const Method*> methods_;
+  std::vector<const Class*> classes_;
+  std::vector<const Category*> categories_;
+};
+
+}
+#endif
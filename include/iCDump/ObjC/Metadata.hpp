@@ -17,52 +17,145 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include "iCDump/iterators.hpp"
+#include "iCDump/ObjC/ImpIndex.hpp"
+#include "iCDump/ObjC/MethodStore.hpp"
+#include "iCDump/ObjC/SelectorIndex.hpp"
+#include "iCDump/ObjC/TypeCache.hpp"
+
+namespace iCDump {
+class Arena;
+}
 
 namespace iCDump::ObjC {
 
 // Forward definitions
+class Category;
 class Class;
+class ClassHandle;
 class Parser;
 class Protocol;
 
 class Metadata {
   friend class Parser;
   public:
-  Metadata() = default;
-  ~Metadata() = default;
+  Metadata();
+  ~Metadata();
 
   Metadata(const Metadata&) = delete;
   Metadata& operator=(const Metadata&) = delete;
 
-  using classes_t   = std::vector<std::unique_ptr<Class>>;
-  using protocols_t = std::vector<std::unique_ptr<Protocol>>;
+  using classes_t    = std::vector<Class*>;
+  using protocols_t  = std::vector<Protocol*>;
+  using categories_t = std::vector<Category*>;
+  using class_refs_t  = std::vector<std::string_view>;
+  using class_handles_t = std::vector<ClassHandle*>;
 
-  using classes_it_t  = const_ref_iterator<const classes_t&, Class*>;
-  using protocol_it_t = const_ref_iterator<const protocols_t&, Protocol*>;
+  using classes_it_t    = const_ref_iterator<const classes_t&>;
+  using protocol_it_t   = const_ref_iterator<const protocols_t&>;
+  using categories_it_t = const_ref_iterator<const categories_t&>;
+  using class_handles_it_t = const_ref_iterator<const class_handles_t&>;
 
   inline classes_it_t classes() const {
     return classes_;
   }
 
+  //! Handles on the classes of __objc_classlist (in the same order as
+  //! classes()). This is the only way to access the classes of a lazy Metadata.
+  inline class_handles_it_t class_handles() const {
+    return class_handles_;
+  }
+
+  //! True if the classes are decoded on demand (LOAD_MODE::LAZY). In this
+  //! case, classes(), categories(), class_refs() and the indexes are empty.
+  //! The categories of a class are merged in the class when it is resolved.
+  inline bool is_lazy() const {
+    return parser_ != nullptr;
+  }
+
+  //! With a lazy Metadata, the protocols which are only referenced by
+  //! the classes and the categories are also decoded upfront: the list is
+  //! the same as in the other modes and it is not modified afterwards
   inline protocol_it_t protocols() const {
     return protocols_;
   }
 
+  //! Categories of __objc_catlist and __objc_catlist2. The categories
+  //! of the classes defined in this image are also merged in these classes.
+  inline categories_it_t categories() const {
+    return categories_;
+  }
+
+  //! Names of the classes referenced by the code (__objc_classrefs),
+  //! including the classes imported from another image
+  inline const class_refs_t& class_refs() const {
+    return class_refs_;
+  }
+
+  //! Columnar representation of the methods of all the classes
+  //! (including the metaclasses) and all the protocols
+  inline const MethodStore& method_store() const {
+    return method_store_;
+  }
+
+  //! Index of the method implementations by address
+  inline const ImpIndex& imp_index() const {
+    return imp_index_;
+  }
+
+  //! Index of the classes, metaclasses and protocols by selector
+  inline const SelectorIndex& selector_index() const {
+    return selector_index_;
+  }
+
+  //! Decoded type encodings of the methods and the ivars
+  inline TypeCache& type_cache() const {
+    return type_cache_;
+  }
+
+  //! Return the class with the given name. With a lazy Metadata,
+  //! the class is decoded on the first call.
   const Class* get_class(const std::string& name) const;
+  const ClassHandle* get_class_handle(const std::string& name) const;
   const Protocol* get_protocol(const std::string& name) const;
 
+  //! Declarations of the protocols and the classes. Thread-safe: the
+  //! declarations are generated with the clang context of the calling thread.
   std::string to_decl() const;
   std::string to_string() const;
 
   private:
+  //! Classes of __objc_classlist
   classes_t classes_;
-  std::unordered_map<std::string, Class*> classes_lookup_;
+  std::unordered_map<std::string_view, Class*> classes_lookup_;
 
   protocols_t protocols_;
-  std::unordered_map<std::string, Protocol*> protocol_lookup_;
+  std::unordered_map<std::string_view, Protocol*> protocol_lookup_;
+
+  class_handles_t class_handles_;
+  std::unordered_map<std::string_view, ClassHandle*> class_handles_lookup_;
+
+  categories_t categories_;
+  class_refs_t class_refs_;
+
+  MethodStore method_store_;
+  ImpIndex imp_index_;
+  SelectorIndex selector_index_;
+  mutable TypeCache type_cache_;
+
+  //! Owner of the image's content when the strings of the
+  //! ObjC objects reference it (see Parser::parse)
+  std::shared_ptr<const void> storage_;
+
+  //! Owner of all the ObjC objects (including the metaclasses and the
+  //! superclasses that are not listed in __objc_classlist) and their strings
+  std::vector<std::unique_ptr<Arena>> arenas_;
 
+  //! Parser of a lazy Metadata. It owns the image and the
+  //! arenas of the classes decoded after the parsing.
+  std::unique_ptr<Parser> parser_;
 };
 
 }
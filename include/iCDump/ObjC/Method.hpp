@@ -14,14 +14,20 @@
  */
 #ifndef ICDUMP_OBJCMETHOD_H_
 #define ICDUMP_OBJCMETHOD_H_
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
+#include "iCDump/iterators.hpp"
+#include "iCDump/span.hpp"
+
 namespace iCDump::ObjC {
 class Parser;
 class Protocol;
 class Class;
+class TypeCache;
 struct Type;
 
 class Method {
@@ -30,19 +36,25 @@ class Method {
   friend class Protocol;
   friend class Class;
 
+  using params_t    = span<const Type* const>;
+  using params_it_t = const_ref_iterator<params_t>;
+
+  //! The types are owned by the TypeCache of the Metadata
   struct prototype_t {
-    std::unique_ptr<Type> rtype;
-    std::vector<std::unique_ptr<Type>> params;
+    const Type* rtype = nullptr;
+    params_t params;
   };
 
   Method() = default;
-  static std::unique_ptr<Method> create(Parser& parser, bool is_small);
+  Method(const Method&) = delete;
+  Method& operator=(const Method&) = delete;
+  static Method* create(const Parser& parser, uintptr_t address, bool is_small);
 
-  inline const std::string& name() const {
+  inline std::string_view name() const {
     return name_;
   }
 
-  inline const std::string& mangled_type() const {
+  inline std::string_view mangled_type() const {
     return mangled_type_;
   }
 
@@ -54,14 +66,19 @@ class Method {
     return is_instance_;
   }
 
-  prototype_t prototype() const;
+  //! Decode the prototype on the first call and return the cached one
+  //! on the next calls. This function is thread-safe.
+  const prototype_t& prototype() const;
 
   std::string to_string() const;
 
   private:
-  std::string name_;
-  std::string mangled_type_;
+  std::string_view name_;
+  std::string_view mangled_type_;
   uintptr_t   addr_ = 0;
+  TypeCache* type_cache_ = nullptr;
+  mutable std::once_flag prototype_once_;
+  mutable prototype_t prototype_;
 
   bool is_instance_ = true;
 };
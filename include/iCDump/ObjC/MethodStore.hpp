@@ -0,0 +1,123 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_METHOD_STORE_H_
+#define ICDUMP_OBJC_METHOD_STORE_H_
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "iCDump/span.hpp"
+
+namespace iCDump::ObjC {
+class Method;
+class Parser;
+
+//! Columnar (structure of arrays) representation of all the methods
+//! of a Metadata.
+//!
+//! The row ``i`` of each column describes the method ``methods()[i]``.
+//! The rows of a class (or a protocol) are contiguous and
+//! Class::methods() / Protocol::*_methods() are views over them.
+class MethodStore {
+  public:
+  friend class Parser;
+
+  using id_t = uint32_t;
+  static constexpr id_t NO_ID = static_cast<id_t>(-1);
+
+  //! Value of owners() for the classes which are not listed in
+  //! __objc_classlist (e.g. a superclass only referenced by a class)
+  static constexpr uint32_t NO_OWNER = static_cast<uint32_t>(-1);
+
+  enum FLAGS : uint8_t {
+    INSTANCE = 1 << 0, ///< Instance method (class method otherwise)
+    OPTIONAL = 1 << 1, ///< Optional method of a protocol
+    PROTOCOL = 1 << 2, ///< The owner is a protocol
+    CATEGORY = 1 << 3, ///< The owner is a category of a class defined in another image
+  };
+
+  MethodStore() = default;
+  MethodStore(const MethodStore&) = delete;
+  MethodStore& operator=(const MethodStore&) = delete;
+
+  inline size_t size() const {
+    return methods_.size();
+  }
+
+  //! Id of the selector (see string())
+  inline const std::vector<id_t>& selectors() const {
+    return selectors_;
+  }
+
+  //! Id of the type encoding (see string())
+  inline const std::vector<id_t>& types() const {
+    return types_;
+  }
+
+  inline const std::vector<uint64_t>& imps() const {
+    return imps_;
+  }
+
+  //! Index of the owner in Metadata::classes() or, if the PROTOCOL flag
+  //! is set, in Metadata::protocols() or, if the CATEGORY flag is set, in
+  //! Metadata::categories(). The methods of a metaclass are owned by its class
+  //! and the methods of a category are owned by the class it extends.
+  inline const std::vector<uint32_t>& owners() const {
+    return owners_;
+  }
+
+  inline const std::vector<uint8_t>& flags() const {
+    return flags_;
+  }
+
+  inline const std::vector<Method*>& methods() const {
+    return methods_;
+  }
+
+  //! Selector or type encoding associated with the given id. Two strings
+  //! are equal if and only if they have the same id.
+  inline std::string_view string(id_t id) const {
+    return strings_[id];
+  }
+
+  //! Number of unique selectors and type encodings
+  inline size_t nb_strings() const {
+    return strings_.size();
+  }
+
+  //! Id of the given selector or type encoding (NO_ID if it is not used)
+  id_t find(std::string_view str) const;
+
+  private:
+  //! Append the given methods and return the view over their rows. The
+  //! capacity must have been reserved such as the views remain valid.
+  span<Method* const> append(span<Method* const> methods, uint32_t owner, uint8_t flags);
+  void reserve(size_t size);
+  id_t intern(std::string_view str);
+
+  std::vector<id_t>     selectors_;
+  std::vector<id_t>     types_;
+  std::vector<uint64_t> imps_;
+  std::vector<uint32_t> owners_;
+  std::vector<uint8_t>  flags_;
+  std::vector<Method*>  methods_;
+
+  std::vector<std::string_view> strings_;
+  std::unordered_map<std::string_view, id_t> lookup_;
+};
+
+}
+#endif
@@ -14,56 +14,202 @@
  */
 #ifndef ICDUMP_OBJC_PARSER_H_
 #define ICDUMP_OBJC_PARSER_H_
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
+#include <LIEF/errors.hpp>
+
 #include "iCDump/NonCopyable.hpp"
-namespace LIEF {
-class BinaryStream;
-namespace MachO {
+namespace LIEF::MachO {
 class Binary;
 }
+
+namespace iCDump {
+class Arena;
+class ChainedFixups;
+class MachOImage;
+class MachOReader;
+class StringPool;
 }
 
 namespace iCDump::ObjC {
 class Metadata;
+class Category;
+struct class_ro_t;
 class Class;
 class Method;
+class Property;
 class Protocol;
+class TypeCache;
 class Parser : protected NonCopyable {
   public:
-  static std::unique_ptr<Metadata> parse(const LIEF::MachO::Binary& bin);
+  //! Owner of the memory which contains the image (e.g. the file mapping)
+  using storage_t = std::shared_ptr<const void>;
+
+  //! ``nb_threads`` is the number of threads used to decode __objc_classlist
+  //! and __objc_protolist (0 means the number of hardware threads).
+  //!
+  //! The strings (names, type encodings, ...) are copied as the Metadata
+  //! doesn't own the LIEF binary.
+  static std::unique_ptr<Metadata> parse(const LIEF::MachO::Binary& bin, size_t nb_threads = 1);
+
+  //! The strings reference the image's content without being copied. The
+  //! content must outlive the Metadata which holds ``storage`` for this purpose.
+  static std::unique_ptr<Metadata> parse(const MachOImage& image, size_t nb_threads = 1,
+                                         storage_t storage = nullptr);
 
-  inline LIEF::BinaryStream& stream() {
-    return *stream_;
+  //! Only decode the names of the classes (see ClassHandle). The Parser
+  //! and the image are kept alive by the Metadata to decode the classes
+  //! on demand.
+  static std::unique_ptr<Metadata> parse_lazy(std::unique_ptr<MachOImage> image,
+                                              size_t nb_threads = 1,
+                                              storage_t storage = nullptr);
+
+  ~Parser();
+
+  //! Stateless reader which can be shared by the threads
+  inline const MachOReader& reader() const {
+    return *reader_;
   }
 
-  inline const LIEF::MachO::Binary& bin() const {
-    return *bin_;
+  inline const MachOImage& image() const {
+    return *image_;
   }
 
   inline uintptr_t imagebase() const {
     return imagebase_;
   }
 
-  Protocol* get_or_create_protocol(uintptr_t offset);
+  //! Arena of the calling thread in which the ObjC objects are allocated
+  //! (one per thread and per parser). The arenas are transferred to the
+  //! Metadata at the end of the parsing.
+  Arena& arena() const;
+
+  //! Type encodings of the Metadata being built
+  inline TypeCache& type_cache() const {
+    return *type_cache_;
+  }
+
+  //! Return the given string of the image either as-is or as a copy in
+  //! the arena, depending on whether the Metadata can reference the image
+  std::string_view make_string(std::string_view str) const;
+
+  //! Return the NUL-terminated string located at the given address.
+  //! The strings of the C-string sections are resolved through the
+  //! StringPool, the others are read from the image.
+  LIEF::result<std::string_view> string_at(uintptr_t address) const;
+
+  //! Unique strings of the C-string sections
+  inline const StringPool& strings() const {
+    return *strings_;
+  }
+
+  //! Return the protocol located at the given address, parsing it (and the
+  //! protocols it adopts) only the first time. This function is thread-safe.
+  Protocol* get_or_create_protocol(uintptr_t address);
+
+  //! Resolve the protocols of the protocol_list_t located at the given address
+  std::vector<Protocol*> get_or_create_protocols(uintptr_t address);
+
+  //! Return the class located at the given address, parsing it (and
+  //! its metaclass/superclass) only the first time
+  Class* get_or_create_class(uintptr_t address);
 
-  uintptr_t decode_ptr(uintptr_t ptr);
+  //! Thread-safe version of get_or_create_class() used by the ClassHandle
+  Class* resolve_class(uintptr_t address);
+
+  //! Read the class_ro_t of the objc_class_t located at the given address
+  LIEF::result<class_ro_t> read_class_ro(uintptr_t address) const;
+
+  //! Decode the methods of the method_list_t located at the given address
+  std::vector<Method*> read_methods(uintptr_t address, bool is_instance) const;
+
+  //! Decode the properties of the property_list_t located at the given address
+  std::vector<Property*> read_properties(uintptr_t address) const;
+
+  //! Return the symbol bound to the pointer located at the given address
+  //! or an empty string if this pointer is not bound
+  std::string_view bound_symbol(uintptr_t address) const;
+
+  //! Name of the class (defined in another image) bound to the pointer
+  //! located at the given address: ``_OBJC_CLASS_$_NSObject`` -> ``NSObject``
+  std::string_view bound_class(uintptr_t address) const;
+
+  //! Chained fixups used to decode the pointers (if any)
+  inline const ChainedFixups* chained_fixups() const {
+    return fixups_;
+  }
+
+  //! Address targeted by the given pointer of the image. If the image uses
+  //! chained fixups, the pointer is decoded according to its format and a
+  //! bind is decoded as 0 (see bound_symbol()).
+  uintptr_t decode_ptr(uintptr_t ptr) const;
 
   private:
   Parser& process_classes();
-  Parser& process_classes(LIEF::BinaryStream& mstream, LIEF::BinaryStream& classlist);
+  Parser& process_classes(const std::vector<uintptr_t>& locations);
+  Parser& process_class_handles();
+  void add_class_handle(uintptr_t address, std::string_view name, Class* cls);
   Parser& process_protocols();
-  Parser& process_protocols(LIEF::BinaryStream& mstream, LIEF::BinaryStream& protolist);
+  Parser& process_protocols(const std::vector<uintptr_t>& locations);
+  Parser& process_categories();
+  Parser& process_categories(const std::vector<uintptr_t>& locations);
+  Parser& index_categories();
+  Parser& process_class_refs();
+  Parser& build_indexes();
+
+  Protocol* register_protocol(uintptr_t address, Protocol* proto);
+  void link_protocol(uintptr_t address, Protocol& proto);
+  void flush_protocols();
 
+  Class* register_class(uintptr_t address, Class* cls);
+  void link_class(uintptr_t address, Class& cls);
+  void attach_category(Category& cat, Class& cls);
+  void attach_lazy_categories(uintptr_t address, Class& cls);
 
-  Parser();
-  Parser(const LIEF::MachO::Binary* bin);
-  const LIEF::MachO::Binary* bin_ = nullptr;
+  static std::unique_ptr<Metadata> parse(const MachOImage& image, size_t nb_threads,
+                                         storage_t storage, bool copy_strings);
+
+  Parser(const MachOImage* image, size_t nb_threads, bool copy_strings);
+  const MachOImage* image_ = nullptr;
   uintptr_t imagebase_ = 0;
-  std::unique_ptr<LIEF::BinaryStream>  stream_;
+  const ChainedFixups* fixups_ = nullptr;
+  size_t nb_threads_ = 1;
+  bool copy_strings_ = true;
+  uint64_t id_ = 0;
+  mutable std::vector<std::unique_ptr<Arena>> arenas_;
+  //! Arena of each thread (among arenas_) so that a thread which alternates
+  //! between several lazy Metadata keeps using the same arena per parser
+  mutable std::unordered_map<std::thread::id, Arena*> thread_arenas_;
+  mutable std::mutex arenas_mutex_;
+  std::unique_ptr<MachOReader> reader_;
+  std::unique_ptr<StringPool> strings_;
   std::unique_ptr<Metadata> metadata_;
+  TypeCache* type_cache_ = nullptr;
 
   std::unordered_map<uintptr_t, Protocol*> protocols_;
+  //! Protocols that are not listed in __objc_protolist. They are added
+  //! to the Metadata in the order of their address
+  std::map<uintptr_t, Protocol*> pending_protocols_;
+  std::recursive_mutex protocols_mutex_;
+
+  std::unordered_map<uintptr_t, Class*> classes_;
+  std::recursive_mutex classes_mutex_;
+
+  //! Lazy parser: address of a class -> its categories in the order of
+  //! __objc_catlist. They are attached when the class is decoded.
+  std::unordered_map<uintptr_t, std::vector<uintptr_t>> lazy_categories_;
+
+  //! Image owned by a lazy parser
+  std::unique_ptr<const MachOImage> owned_image_;
+
+  //! Address of a bound pointer -> symbol
+  std::unordered_map<uintptr_t, std::string_view> bindings_;
 };
 
 }
@@ -15,6 +15,7 @@
 #ifndef ICDUMP_OBJC_PROPERTY_H_
 #define ICDUMP_OBJC_PROPERTY_H_
 #include <string>
+#include <string_view>
 #include <memory>
 
 namespace iCDump::ObjC {
@@ -25,13 +26,13 @@ class Property {
   friend class Parser;
 
   Property() = default;
-  static std::unique_ptr<Property> create(Parser& parser);
+  static Property* create(const Parser& parser, uintptr_t address);
 
-  inline const std::string& name() const {
+  inline std::string_view name() const {
     return name_;
   }
 
-  inline const std::string& attribute() const {
+  inline std::string_view attribute() const {
     return attributes_;
   }
 
@@ -39,8 +40,8 @@ class Property {
   std::string to_decl() const;
 
   private:
-  std::string name_;
-  std::string attributes_;
+  std::string_view name_;
+  std::string_view attributes_;
 };
 
 }
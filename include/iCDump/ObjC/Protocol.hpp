@@ -15,10 +15,12 @@
 #ifndef ICDUMP_OBJC_PROTOCOL_H_
 #define ICDUMP_OBJC_PROTOCOL_H_
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
 #include "iCDump/iterators.hpp"
+#include "iCDump/span.hpp"
 
 namespace iCDump::ObjC {
 class Method;
@@ -29,22 +31,30 @@ class Property;
 class Protocol {
   public:
   friend class Parser;
-  using methods_t    = std::vector<std::unique_ptr<Method>>;
-  using properties_t = std::vector<std::unique_ptr<Property>>;
+  using protocols_t  = std::vector<Protocol*>;
+  //! View over the rows of the Metadata's MethodStore
+  using methods_t    = span<Method* const>;
+  using properties_t = std::vector<Property*>;
 
-  using methods_it_t    = const_ref_iterator<const methods_t&, Method*>;
-  using properties_it_t = const_ref_iterator<const properties_t&, Property*>;
+  using protocols_it_t  = const_ref_iterator<const protocols_t&>;
+  using methods_it_t    = const_ref_iterator<methods_t>;
+  using properties_it_t = const_ref_iterator<const properties_t&>;
 
-  static std::unique_ptr<Protocol> create(Parser& parser);
+  static Protocol* create(const Parser& parser, uintptr_t address);
 
   Protocol();
   Protocol(const Protocol&) = delete;
   Protocol& operator=(const Protocol&) = delete;
 
-  inline const std::string& mangled_name() const {
+  inline std::string_view mangled_name() const {
     return mangled_name_;
   }
 
+  //! Protocols adopted by this protocol
+  inline protocols_it_t protocols() const {
+    return protocols_;
+  }
+
   inline methods_it_t optional_methods() const {
     return opt_methods_;
   }
@@ -61,10 +71,14 @@ class Protocol {
   //std::string name() const;
 
   std::string to_string() const;
+
+  //! Objective-C declaration of the protocol (same threading
+  //! contract as Class::to_decl())
   std::string to_decl() const;
   private:
-  std::string mangled_name_;
+  std::string_view mangled_name_;
 
+  protocols_t protocols_;
   methods_t opt_methods_;
   methods_t required_methods_;
   properties_t properties_;
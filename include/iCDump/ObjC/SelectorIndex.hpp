@@ -0,0 +1,81 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_SELECTOR_INDEX_H_
+#define ICDUMP_OBJC_SELECTOR_INDEX_H_
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "iCDump/span.hpp"
+#include "iCDump/ObjC/MethodStore.hpp"
+
+namespace iCDump::ObjC {
+class Parser;
+
+//! Reverse index from a selector to the methods (rows of the MethodStore)
+//! which implement or declare it: classes, metaclasses and protocols
+//! (required and optional).
+//!
+//! The owner and the kind of each row are given by MethodStore::owners()
+//! and MethodStore::flags().
+class SelectorIndex {
+  public:
+  friend class Parser;
+  using id_t       = MethodStore::id_t;
+  using postings_t = span<const uint32_t>;
+
+  SelectorIndex() = default;
+  SelectorIndex(const SelectorIndex&) = delete;
+  SelectorIndex& operator=(const SelectorIndex&) = delete;
+
+  //! Number of unique selectors
+  inline size_t size() const {
+    return selectors_.size();
+  }
+
+  //! Selectors (MethodStore ids) in lexicographic order
+  inline const std::vector<id_t>& selectors() const {
+    return selectors_;
+  }
+
+  inline std::string_view selector(id_t id) const {
+    return store_->string(id);
+  }
+
+  //! Rows of the methods with the given selector (empty if not found)
+  postings_t find(std::string_view selector) const;
+
+  //! Rows of the methods with the given selector id
+  postings_t postings(id_t selector) const;
+
+  //! Selectors starting with the given prefix, in lexicographic order
+  span<const id_t> prefix(std::string_view prefix) const;
+
+  private:
+  void build(const MethodStore& store);
+
+  const MethodStore* store_ = nullptr;
+  std::vector<id_t> selectors_;
+
+  //! Position of a MethodStore id in selectors_
+  std::vector<uint32_t> positions_;
+
+  //! Postings of selectors_[i] are postings_[offsets_[i], offsets_[i + 1])
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> postings_;
+};
+
+}
+#endif
@@ -0,0 +1,73 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_TYPE_CACHE_H_
+#define ICDUMP_OBJC_TYPE_CACHE_H_
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "iCDump/span.hpp"
+
+namespace iCDump {
+class Arena;
+}
+
+namespace iCDump::ObjC {
+struct Type;
+
+//! Interning cache of the decoded type encodings, shared by the methods
+//! and the ivars of a Metadata.
+//!
+//! An encoding is decoded only once: the next lookups return the same
+//! immutable types. The types are also shared at the level of the
+//! components of the encodings (without their stack offsets) such as
+//! ``v16@0:8`` and ``@24@0:8`` share the nodes of ``@`` and ``:``.
+//! This class is thread-safe.
+class TypeCache {
+  public:
+  using types_t = span<const Type* const>;
+
+  TypeCache();
+  ~TypeCache();
+
+  TypeCache(const TypeCache&) = delete;
+  TypeCache& operator=(const TypeCache&) = delete;
+
+  //! Decoded types of the given encoding (empty if it can't be decoded).
+  //! The types are owned by the cache.
+  types_t decode(std::string_view encoded);
+
+  //! Number of distinct encodings in the cache
+  size_t size() const;
+
+  //! Number of distinct (component) types in the cache
+  size_t nb_types() const;
+
+  private:
+  const Type* intern(std::string_view encoded, std::unique_ptr<Type> type);
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string_view, types_t> encodings_;
+  std::unordered_map<std::string_view, const Type*> components_;
+  std::vector<std::unique_ptr<Type>> types_;
+
+  //! Owner of the keys and the spans
+  std::unique_ptr<Arena> arena_;
+};
+
+}
+#endif
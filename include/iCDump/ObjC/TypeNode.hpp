@@ -0,0 +1,87 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_TYPE_NODE_H_
+#define ICDUMP_OBJC_TYPE_NODE_H_
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "iCDump/Arena.hpp"
+#include "iCDump/ObjC/TypesEncoding.hpp"
+
+namespace iCDump::ObjC {
+struct FieldNode;
+
+//! Bitmask of OBJC_TYPE_SPECIFIERS
+using type_specifiers_mask_t = uint16_t;
+
+constexpr type_specifiers_mask_t specifier_bit(OBJC_TYPE_SPECIFIERS spec) {
+  return static_cast<type_specifiers_mask_t>(1u << static_cast<uint32_t>(spec));
+}
+
+//! Lightweight counterpart of Type (and its subclasses) which is allocated
+//! in an Arena. The names are views on the decoded encoding which must
+//! outlive the nodes.
+struct TypeNode {
+  OBJC_TYPES type = OBJC_TYPES::UNKNOWN;
+  type_specifiers_mask_t specifiers = 0;
+
+  //! Name of a STRUCT, a UNION or an OBJECT
+  std::string_view name;
+
+  //! Dimension of an ARRAY or size of a BIT_FIELD
+  size_t size = 0;
+
+  //! Pointee of a POINTER or element type of an ARRAY (can be null)
+  const TypeNode* subtype = nullptr;
+
+  //! First field of a STRUCT or a UNION
+  const FieldNode* fields = nullptr;
+
+  //! Next type of the encoding (e.g. the next parameter of a method)
+  const TypeNode* next = nullptr;
+
+  inline bool has_specifier(OBJC_TYPE_SPECIFIERS spec) const {
+    return (specifiers & specifier_bit(spec)) != 0;
+  }
+};
+
+struct FieldNode {
+  //! Optional name of the field
+  std::string_view name;
+  //! Type of the field (can be null)
+  const TypeNode* type = nullptr;
+  const FieldNode* next = nullptr;
+};
+
+//! Decode the given encoding into nodes allocated in ``arena``. It returns
+//! the first type of the encoding (the others are chained with TypeNode::next)
+//! or nullptr if the encoding is empty.
+//!
+//! This function produces the same trees as decode_type() without any
+//! allocation outside of the arena. The arena can be reset() between two
+//! encodings to reuse its memory:
+//!
+//! ```
+//! Arena arena;
+//! for (const std::string& encoding : encodings) {
+//!   arena.reset();
+//!   const TypeNode* types = decode_nodes(encoding, arena);
+//!   ...
+//! }
+//! ```
+const TypeNode* decode_nodes(std::string_view encoded, Arena& arena);
+}
+#endif
@@ -0,0 +1,92 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_TYPE_VISITOR_H_
+#define ICDUMP_OBJC_TYPE_VISITOR_H_
+#include <cstddef>
+#include <string_view>
+
+#include "iCDump/ObjC/TypesEncoding.hpp"
+
+namespace iCDump::ObjC {
+
+//! Callbacks of walk_type() which reports the types of an encoding in a
+//! single pass, without building them. The default callbacks do nothing.
+//!
+//! For instance, ``@24@0:8@?16`` is reported as:
+//!
+//! ```
+//! enter_type() visit_object("") leave_type("@")
+//! enter_type() visit_object("") leave_type("@")
+//! enter_type() visit_leaf(SELECTOR) leave_type(":")
+//! enter_type() visit_leaf(BLOCK) leave_type("@?")
+//! ```
+//!
+//! The composite types (pointers, arrays, structures and unions) report
+//! their content between their enter_* and leave_* callbacks. A type that
+//! can't be decoded is reported with invalid(): for a composite type, it
+//! is the ``valid`` parameter of its leave_* callback which is false.
+class TypeVisitor {
+  public:
+  virtual ~TypeVisitor();
+
+  //! Start of a top-level type (e.g. the return type of a method)
+  virtual void enter_type() {}
+
+  //! End of a top-level type. ``encoding`` is its encoding (without the
+  //! stack offset) as a view on the walked encoding.
+  virtual void leave_type(std::string_view encoding) {}
+
+  //! Specifier (const, in, out, ...) of the next type
+  virtual void visit_specifier(OBJC_TYPE_SPECIFIERS spec) {}
+
+  //! Primitive types, CLASS, SELECTOR, BLOCK and UNKNOWN ('?')
+  virtual void visit_leaf(OBJC_TYPES type) {}
+
+  //! Object with its optional class name: ``@"NSString"``
+  virtual void visit_object(std::string_view name) {}
+
+  virtual void visit_bitfield(size_t size) {}
+
+  virtual void enter_pointer() {}
+  virtual void leave_pointer(bool valid) {}
+
+  virtual void enter_array(size_t dim) {}
+  virtual void leave_array(bool valid) {}
+
+  //! STRUCT or UNION. The type of each field follows visit_field()
+  virtual void enter_record(OBJC_TYPES type, std::string_view name) {}
+  virtual void visit_field(std::string_view name) {}
+  virtual void leave_record(bool valid) {}
+
+  virtual void invalid() {}
+
+  //! Stop the walk after the current callback
+  inline void stop() {
+    stopped_ = true;
+  }
+
+  inline bool stopped() const {
+    return stopped_;
+  }
+
+  private:
+  bool stopped_ = false;
+};
+
+//! Walk the types of the given encoding. The views given to the visitor
+//! reference ``encoded``.
+void walk_type(std::string_view encoded, TypeVisitor& visitor);
+}
+#endif
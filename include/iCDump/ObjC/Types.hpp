@@ -30,6 +30,7 @@ struct objc_image_info_t {
 };
 
 struct objc_object_t {
+  uintptr_t isa;
 };
 
 
@@ -154,6 +155,16 @@ struct protocol_list_t {
   uintptr_t count;
 };
 
+// Listed in __objc_catlist and __objc_catlist2
+struct category_t {
+  ptr_t name;
+  ptr_t cls; // Bound if the class is defined in another image
+  ptr_t instance_methods;
+  ptr_t class_methods;
+  ptr_t protocols;
+  ptr_t instance_properties;
+};
+
 
 struct class_ro_t {
   uint32_t flags;
@@ -212,8 +223,8 @@ struct cache_t {
       uint16_t flags;
       uint16_t occupied;
     };
+    uintptr_t original_preopt_cache;
   };
-  uintptr_t original_preopt_cache;
 };
 
 struct class_data_bits_t {
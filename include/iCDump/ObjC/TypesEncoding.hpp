@@ -14,10 +14,13 @@
  */
 #ifndef ICDUMP_TYPESENC_H_
 #define ICDUMP_TYPESENC_H_
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 #include <variant>
 #include <set>
 
@@ -55,6 +58,11 @@ enum class OBJC_TYPES {
 
 const char* to_string(OBJC_TYPES type);
 
+//! Check if the given type is represented by a PrimitiveTy
+inline constexpr bool is_primitive(OBJC_TYPES type) {
+  return OBJC_TYPES::CHAR <= type && type <= OBJC_TYPES::CSTRING;
+}
+
 
 enum class OBJC_TYPE_SPECIFIERS {
   UNKNOWN = 0,
@@ -90,7 +98,7 @@ struct PrimitiveTy : public Type {
   PrimitiveTy(OBJC_TYPES t) : Type{t} {}
 
   inline static bool classof(const Type& t) {
-    return OBJC_TYPES::CHAR <= t.type && t.type <= OBJC_TYPES::CSTRING;
+    return is_primitive(t.type);
   }
 };
 
@@ -144,7 +152,7 @@ struct StructTy : Type {
   StructTy& operator=(const StructTy&) = delete;
 
   StructTy(std::string name, attributes_t attrs) :
-    Type{OBJC_TYPES::STRUCT}, name(name), attributes(std::move(attrs)) {}
+    Type{OBJC_TYPES::STRUCT}, name(std::move(name)), attributes(std::move(attrs)) {}
 
   std::string name;
   attributes_t attributes;
@@ -158,7 +166,7 @@ struct UnionTy : Type {
   UnionTy& operator=(const UnionTy&) = delete;
 
   UnionTy(std::string name, attributes_t attrs) :
-    Type{OBJC_TYPES::UNION}, name(name), attributes(std::move(attrs)) {}
+    Type{OBJC_TYPES::UNION}, name(std::move(name)), attributes(std::move(attrs)) {}
 
   std::string name;
   attributes_t attributes;
@@ -171,7 +179,29 @@ struct BitFieldTy : Type {
 };
 
 
-static const std::unordered_map<char, OBJC_TYPES> OBJC_TYPES_ID {
+namespace details {
+template<class T, size_t N>
+constexpr std::array<T, 256> make_table(const std::pair<char, T> (&entries)[N]) {
+  std::array<T, 256> table{};
+  for (const std::pair<char, T>& entry : entries) {
+    table[static_cast<uint8_t>(entry.first)] = entry.second;
+  }
+  return table;
+}
+
+template<class T, size_t N>
+constexpr std::array<bool, 256> make_set(const std::pair<char, T> (&entries)[N]) {
+  std::array<bool, 256> table{};
+  for (const std::pair<char, T>& entry : entries) {
+    table[static_cast<uint8_t>(entry.first)] = true;
+  }
+  return table;
+}
+}
+
+//! Characters that encode a type. '?' encodes OBJC_TYPES::UNKNOWN
+//! (e.g. a function pointer: ``^?``).
+inline constexpr std::pair<char, OBJC_TYPES> OBJC_TYPES_CODES[] = {
   {'c', OBJC_TYPES::CHAR},
   {'i', OBJC_TYPES::INT},
   {'s', OBJC_TYPES::SHORT},
@@ -198,7 +228,15 @@ static const std::unordered_map<char, OBJC_TYPES> OBJC_TYPES_ID {
   {'?', OBJC_TYPES::UNKNOWN},
 };
 
-static const std::unordered_map<char, OBJC_TYPE_SPECIFIERS> OBJC_TSPECIFIERS_ID {
+//! Type encoded by a character. The characters which don't encode a
+//! type are also mapped to OBJC_TYPES::UNKNOWN: see is_type_code().
+inline constexpr std::array<OBJC_TYPES, 256> OBJC_TYPES_ID = details::make_table(OBJC_TYPES_CODES);
+
+//! Whether a character encodes a type (including '?')
+inline constexpr std::array<bool, 256> OBJC_TYPES_VALID = details::make_set(OBJC_TYPES_CODES);
+
+//! Type specifier encoded by a character (UNKNOWN if it is not a specifier)
+inline constexpr std::array<OBJC_TYPE_SPECIFIERS, 256> OBJC_TSPECIFIERS_ID = details::make_table<OBJC_TYPE_SPECIFIERS>({
   {'r', OBJC_TYPE_SPECIFIERS::CONST},
   {'n', OBJC_TYPE_SPECIFIERS::IN},
   {'N', OBJC_TYPE_SPECIFIERS::IN_OUT},
@@ -206,9 +244,12 @@ static const std::unordered_map<char, OBJC_TYPE_SPECIFIERS> OBJC_TSPECIFIERS_ID
   {'O', OBJC_TYPE_SPECIFIERS::BY_COPY},
   {'R', OBJC_TYPE_SPECIFIERS::BY_REF},
   {'V', OBJC_TYPE_SPECIFIERS::ONE_WAY},
-};
+  {'A', OBJC_TYPE_SPECIFIERS::ATOMIC},
+  {'j', OBJC_TYPE_SPECIFIERS::COMPLEX},
+});
 
-static const std::unordered_map<char, OBJC_PROP_SPECIFIERS> OBJC_PROP_SPECIFIERS_ID {
+//! Property attribute encoded by a character (UNKNOWN if it is not an attribute)
+inline constexpr std::array<OBJC_PROP_SPECIFIERS, 256> OBJC_PROP_SPECIFIERS_ID = details::make_table<OBJC_PROP_SPECIFIERS>({
   {'R', OBJC_PROP_SPECIFIERS::READ_ONLY},
   {'C', OBJC_PROP_SPECIFIERS::COPY},
   {'&', OBJC_PROP_SPECIFIERS::REF},
@@ -216,11 +257,31 @@ static const std::unordered_map<char, OBJC_PROP_SPECIFIERS> OBJC_PROP_SPECIFIERS
   {'D', OBJC_PROP_SPECIFIERS::DYNAMIC},
   {'W', OBJC_PROP_SPECIFIERS::WEAK},
   {'P', OBJC_PROP_SPECIFIERS::GARBAGE},
-};
+});
+
+inline constexpr OBJC_TYPES type_id(char c) {
+  return OBJC_TYPES_ID[static_cast<uint8_t>(c)];
+}
+
+inline constexpr bool is_type_code(char c) {
+  return OBJC_TYPES_VALID[static_cast<uint8_t>(c)];
+}
+
+inline constexpr OBJC_TYPE_SPECIFIERS type_specifier_id(char c) {
+  return OBJC_TSPECIFIERS_ID[static_cast<uint8_t>(c)];
+}
+
+inline constexpr OBJC_PROP_SPECIFIERS prop_specifier_id(char c) {
+  return OBJC_PROP_SPECIFIERS_ID[static_cast<uint8_t>(c)];
+}
 
 using types_t = std::vector<std::unique_ptr<Type>>;
 using type_specifiers_t = std::vector<OBJC_TYPE_SPECIFIERS>;
 
 types_t decode_type(const std::string& encoded);
+
+//! Same as decode_type() but also return the encoding of each type (without
+//! its stack offset) as a view on ``encoded``: ``v16@0:8`` -> ``v``, ``@``, ``:``
+types_t decode_type(const std::string& encoded, std::vector<std::string_view>& encodings);
 }
 #endif
@@ -16,9 +16,13 @@
 #define ICDUMP_MAIN_H_
 #include <iCDump/ObjC.hpp>
 #include <iCDump/Logging.hpp>
+#include <iCDump/span.hpp>
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 namespace iCDump {
 
@@ -28,11 +32,69 @@ enum class ARCH {
   ARM,
   X86_64,
   X86,
+  AARCH64E,
+};
+
+enum class LOAD_MODE {
+  /* Only walk the load commands and index the segments & the __objc_ sections.
+   * The names and the type encodings reference the (mapped) file which is
+   * kept alive by the Metadata */
+  METADATA_ONLY = 0,
+  /* Run the full LIEF parser (exports, bindings, ...) before processing the metadata.
+   * The strings are copied as the LIEF binary is released once parsed */
+  FULL,
+  /* Like METADATA_ONLY but only the names of the classes are decoded upfront.
+   * The classes are decoded on demand through Metadata::class_handles() */
+  LAZY,
 };
 
 namespace ObjC {
+//! Metadata of each architecture slice, in the order of the FAT header
+using slices_metadata_t = std::vector<std::pair<ARCH, std::unique_ptr<ObjC::Metadata>>>;
+
+//! Metadata of the Mach-O files embedded in an IPA, keyed by their path in the archive
+using ipa_metadata_t = std::vector<std::pair<std::string, std::unique_ptr<ObjC::Metadata>>>;
+
+//! Parse the slice matching the given architecture. With ARCH::AUTO,
+//! AArch64 is selected first and then x86-64.
+//! ``nb_threads`` is the number of threads used to decode the classes and
+//! the protocols of the slice (0 means the number of hardware threads).
 std::unique_ptr<ObjC::Metadata> parse(const std::string& file_path,
-                                      ARCH arch = ARCH::AUTO);
+                                      ARCH arch = ARCH::AUTO,
+                                      LOAD_MODE mode = LOAD_MODE::METADATA_ONLY,
+                                      size_t nb_threads = 1);
+
+//! Parse an in-memory Mach-O file. The buffer is not copied (except in
+//! LOAD_MODE::FULL): it must remain valid as long as the returned Metadata
+//! is alive. If provided, ``owner`` is held by the Metadata for this purpose.
+std::unique_ptr<ObjC::Metadata> parse(span<const uint8_t> buffer,
+                                      ARCH arch = ARCH::AUTO,
+                                      LOAD_MODE mode = LOAD_MODE::METADATA_ONLY,
+                                      size_t nb_threads = 1,
+                                      std::shared_ptr<const void> owner = nullptr);
+
+//! Parse all the slices of the given (FAT) Mach-O file concurrently.
+//! If nb_threads is 0, the number of hardware threads is used.
+slices_metadata_t parse_all(const std::string& file_path,
+                            LOAD_MODE mode = LOAD_MODE::METADATA_ONLY,
+                            size_t nb_threads = 0);
+
+//! In-memory version of parse_all() with the same lifetime requirements
+//! as ObjC::parse(span<const uint8_t>, ...). ``owner`` is shared by the
+//! Metadata of all the slices.
+slices_metadata_t parse_all(span<const uint8_t> buffer,
+                            LOAD_MODE mode = LOAD_MODE::METADATA_ONLY,
+                            size_t nb_threads = 0,
+                            std::shared_ptr<const void> owner = nullptr);
+
+//! Parse the main executable, the frameworks and the extensions of an IPA
+//! without extracting it on disk. The entries of ``Payload/*.app/`` are
+//! inflated in memory and processed concurrently (one Mach-O per task).
+//! If nb_threads is 0, the number of hardware threads is used.
+ipa_metadata_t parse_ipa(const std::string& ipa_path,
+                         ARCH arch = ARCH::AUTO,
+                         LOAD_MODE mode = LOAD_MODE::METADATA_ONLY,
+                         size_t nb_threads = 0);
 }
 
 }
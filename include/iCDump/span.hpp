@@ -0,0 +1,73 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_SPAN_H_
+#define ICDUMP_SPAN_H_
+#include <cstddef>
+#include <type_traits>
+
+namespace iCDump {
+
+// Minimal (C++17) equivalent of std::span: a non-owning view over a
+// contiguous sequence of T
+template<class T>
+class span {
+  public:
+  using element_type   = T;
+  using value_type     = std::remove_cv_t<T>;
+  using pointer        = T*;
+  using iterator       = T*;
+  using const_iterator = T*;
+
+  constexpr span() = default;
+
+  constexpr span(T* data, size_t size) :
+    data_{data}, size_{size}
+  {}
+
+  template<class C>
+  constexpr span(C& container) :
+    data_{container.data()}, size_{container.size()}
+  {}
+
+  constexpr T* data() const {
+    return data_;
+  }
+
+  constexpr size_t size() const {
+    return size_;
+  }
+
+  constexpr bool empty() const {
+    return size_ == 0;
+  }
+
+  constexpr T& operator[](size_t idx) const {
+    return data_[idx];
+  }
+
+  constexpr iterator begin() const {
+    return data_;
+  }
+
+  constexpr iterator end() const {
+    return data_ + size_;
+  }
+
+  private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+};
+}
+#endif
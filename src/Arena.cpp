@@ -0,0 +1,74 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+
+#include "iCDump/Arena.hpp"
+
+namespace iCDump {
+
+Arena::~Arena() {
+  for (dtor_t* it = dtors_; it != nullptr; it = it->next) {
+    it->func(it->obj);
+  }
+}
+
+void Arena::reset() {
+  for (dtor_t* it = dtors_; it != nullptr; it = it->next) {
+    it->func(it->obj);
+  }
+  dtors_ = nullptr;
+
+  // The large allocations and the filled blocks are released
+  uint8_t* current = end_ != nullptr ? end_ - BLOCK_SIZE : nullptr;
+  blocks_.erase(std::remove_if(blocks_.begin(), blocks_.end(),
+                               [current] (const std::unique_ptr<uint8_t[]>& block) {
+                                 return block.get() != current;
+                               }),
+                blocks_.end());
+  cursor_   = current;
+  reserved_ = blocks_.empty() ? 0 : BLOCK_SIZE;
+}
+
+void* Arena::allocate_slow(size_t size, size_t align) {
+  // Large allocations get their own block so that the current one
+  // can still be used
+  if (size + align > BLOCK_SIZE / 4) {
+    auto& block = blocks_.emplace_back(new uint8_t[size + align]);
+    reserved_ += size + align;
+    const auto addr = reinterpret_cast<uintptr_t>(block.get());
+    return reinterpret_cast<void*>((addr + align - 1) & ~(align - 1));
+  }
+
+  auto& block = blocks_.emplace_back(new uint8_t[BLOCK_SIZE]);
+  reserved_ += BLOCK_SIZE;
+  cursor_ = block.get();
+  end_    = cursor_ + BLOCK_SIZE;
+
+  const auto addr = reinterpret_cast<uintptr_t>(cursor_);
+  const uintptr_t aligned = (addr + align - 1) & ~(align - 1);
+  cursor_ = reinterpret_cast<uint8_t*>(aligned + size);
+  return reinterpret_cast<void*>(aligned);
+}
+
+std::string_view Arena::copy(std::string_view str) {
+  if (str.empty()) {
+    return {};
+  }
+  auto* data = static_cast<char*>(allocate(str.size() + 1, alignof(char)));
+  std::memcpy(data, str.data(), str.size());
+  data[str.size()] = '\0';
+  return {data, str.size()};
+}
+}
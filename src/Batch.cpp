@@ -0,0 +1,222 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+
+#include "iCDump/Batch.hpp"
+#include "iCDump/ObjC/Metadata.hpp"
+#include "iCDump/ObjC/Class.hpp"
+#include "log.hpp"
+#include "MachOImage.hpp"
+#include "MemoryMap.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace iCDump::ObjC {
+using STATUS = batch_entry_t::STATUS;
+
+struct input_t {
+  fs::path path;
+  // Output path relative to batch_config_t::output_dir (without the suffix)
+  fs::path relative;
+  uint64_t size = 0;
+};
+
+std::vector<input_t> collect_inputs(const std::vector<std::string>& inputs) {
+  std::vector<input_t> files;
+  for (const std::string& input : inputs) {
+    std::error_code ec;
+    const fs::path root(input);
+    if (fs::is_regular_file(root, ec)) {
+      files.push_back({root, root.filename(), fs::file_size(root, ec)});
+      continue;
+    }
+
+    if (!fs::is_directory(root, ec)) {
+      ICDUMP_ERR("'{}' is not a valid file or directory", input);
+      continue;
+    }
+
+    const fs::path name = root.has_filename() ? root.filename() :
+                                                root.parent_path().filename();
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      std::error_code file_ec;
+      if (!it->is_regular_file(file_ec)) {
+        continue;
+      }
+      const fs::path& path = it->path();
+      files.push_back({path, name / path.lexically_relative(root), it->file_size(file_ec)});
+    }
+
+    if (ec) {
+      ICDUMP_WARN("Error while listing '{}': {}", input, ec.message());
+    }
+  }
+  return files;
+}
+
+//! Interleave the largest and the smallest files
+std::vector<size_t> schedule(const std::vector<input_t>& files) {
+  std::vector<size_t> by_size(files.size());
+  std::iota(by_size.begin(), by_size.end(), 0);
+  std::stable_sort(by_size.begin(), by_size.end(),
+                   [&files] (size_t lhs, size_t rhs) {
+                     return files[lhs].size > files[rhs].size;
+                   });
+
+  std::vector<size_t> order;
+  order.reserve(by_size.size());
+  size_t lo = 0;
+  size_t hi = by_size.size();
+  while (lo < hi) {
+    order.push_back(by_size[lo++]);
+    if (lo < hi) {
+      order.push_back(by_size[--hi]);
+    }
+  }
+  return order;
+}
+
+STATUS dump(const input_t& input, const batch_config_t& config, batch_entry_t& entry) {
+  std::unique_ptr<MemoryMap> mapping = MemoryMap::open(input.path.string());
+  if (!mapping) {
+    return STATUS::ERROR;
+  }
+
+  LIEF::span<const uint8_t> raw = mapping->content();
+  if (!MachOImage::is_macho(raw)) {
+    return STATUS::NOT_MACHO;
+  }
+
+  std::unique_ptr<Metadata> metadata = config.mode == LOAD_MODE::FULL ?
+    parse(input.path.string(), config.arch, config.mode) :
+    parse(span<const uint8_t>(raw.data(), raw.size()), config.arch, config.mode);
+
+  if (!metadata) {
+    return STATUS::ERROR;
+  }
+
+  entry.nb_classes   = metadata->class_handles().size();
+  entry.nb_protocols = metadata->protocols().size();
+
+  if (config.output_dir.empty()) {
+    return STATUS::OK;
+  }
+
+  std::string output;
+  if (config.skip_protocols) {
+    for (const ClassHandle& handle : metadata->class_handles()) {
+      if (const Class* cls = handle.get()) {
+        output += cls->to_decl();
+      }
+    }
+  } else {
+    output = metadata->to_decl();
+  }
+
+  fs::path output_path = fs::path(config.output_dir) / input.relative;
+  output_path += "_objc.h";
+
+  std::error_code ec;
+  fs::create_directories(output_path.parent_path(), ec);
+  std::ofstream ofs(output_path, std::ios::binary | std::ios::trunc);
+  if (!ofs || !ofs.write(output.data(), output.size())) {
+    ICDUMP_ERR("Can't write {}", output_path.string());
+    return STATUS::ERROR;
+  }
+  entry.output_path = output_path.string();
+  return STATUS::OK;
+}
+
+batch_summary_t dump_batch(const std::vector<std::string>& inputs,
+                           const batch_config_t& config,
+                           const batch_callback_t& callback)
+{
+  const auto start = std::chrono::steady_clock::now();
+  const std::vector<input_t> files = collect_inputs(inputs);
+
+  batch_summary_t summary;
+  summary.entries.resize(files.size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    summary.entries[i].path = files[i].path.string();
+    summary.entries[i].size = files[i].size;
+  }
+
+  if (!files.empty()) {
+    const size_t nb_threads = config.nb_threads > 0 ? config.nb_threads :
+                                                      ThreadPool::default_concurrency();
+    const size_t max_inflight = config.max_inflight > 0 ? config.max_inflight :
+                                                          2 * nb_threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t inflight = 0;
+
+    ThreadPool pool(std::min(nb_threads, files.size()));
+    for (size_t idx : schedule(files)) {
+      {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return inflight < max_inflight; });
+        ++inflight;
+      }
+
+      pool.enqueue([&, idx] {
+        batch_entry_t& entry = summary.entries[idx];
+        const auto entry_start = std::chrono::steady_clock::now();
+        entry.status  = dump(files[idx], config, entry);
+        entry.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - entry_start);
+        if (callback) {
+          callback(entry);
+        }
+
+        {
+          std::lock_guard lock(mutex);
+          --inflight;
+        }
+        cv.notify_one();
+      });
+    }
+    pool.wait();
+  }
+
+  for (const batch_entry_t& entry : summary.entries) {
+    switch (entry.status) {
+      case STATUS::OK:        ++summary.nb_success; break;
+      case STATUS::NOT_MACHO: ++summary.nb_skipped; break;
+      case STATUS::ERROR:     ++summary.nb_failed;  break;
+    }
+    summary.nb_bytes += entry.size;
+  }
+  summary.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start);
+  return summary;
+}
+
+std::string batch_summary_t::to_string() const {
+  const double seconds = elapsed.count() / 1000.0;
+  const double mbytes  = nb_bytes / (1024.0 * 1024.0);
+  return fmt::format("{} files ({:.1f} MiB) in {:.2f}s ({:.1f} files/s): "
+                     "{} processed, {} skipped (not Mach-O), {} failed",
+                     entries.size(), mbytes, seconds,
+                     seconds > 0 ? entries.size() / seconds : 0.0,
+                     nb_success, nb_skipped, nb_failed);
+}
+}
@@ -0,0 +1,298 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstring>
+
+#include "ChainedFixups.hpp"
+#include "log.hpp"
+
+namespace iCDump {
+
+namespace details {
+static constexpr uint16_t DYLD_CHAINED_PTR_START_NONE  = 0xFFFF;
+static constexpr uint16_t DYLD_CHAINED_PTR_START_MULTI = 0x8000;
+
+static constexpr uint32_t DYLD_CHAINED_IMPORT          = 1;
+static constexpr uint32_t DYLD_CHAINED_IMPORT_ADDEND   = 2;
+static constexpr uint32_t DYLD_CHAINED_IMPORT_ADDEND64 = 3;
+
+struct dyld_chained_fixups_header {
+  uint32_t fixups_version;
+  uint32_t starts_offset;
+  uint32_t imports_offset;
+  uint32_t symbols_offset;
+  uint32_t imports_count;
+  uint32_t imports_format;
+  uint32_t symbols_format;
+};
+
+// Followed by page_start[page_count]
+struct dyld_chained_starts_in_segment {
+  uint32_t size;
+  uint16_t page_size;
+  uint16_t pointer_format;
+  uint64_t segment_offset;
+  uint32_t max_valid_pointer;
+  uint16_t page_count;
+};
+static constexpr size_t SIZEOF_STARTS_IN_SEGMENT = 22;
+}
+
+template<class T>
+static bool peek(LIEF::span<const uint8_t> raw, uint64_t offset, T& out, size_t size = sizeof(T)) {
+  if (offset > raw.size() || raw.size() - offset < size) {
+    return false;
+  }
+  std::memcpy(&out, raw.data() + offset, size);
+  return true;
+}
+
+//! Distance (in bytes) between two fixups for a ``next`` value of 1
+inline uint32_t stride(uint16_t format) {
+  switch (format) {
+    case ChainedFixups::PTR_ARM64E:
+    case ChainedFixups::PTR_ARM64E_USERLAND:
+    case ChainedFixups::PTR_ARM64E_USERLAND24:
+      return 8;
+    case ChainedFixups::PTR_64:
+    case ChainedFixups::PTR_64_OFFSET:
+    case ChainedFixups::PTR_ARM64E_KERNEL:
+      return 4;
+  }
+  return 0;
+}
+
+inline bool is_arm64e(uint16_t format) {
+  return format == ChainedFixups::PTR_ARM64E || format == ChainedFixups::PTR_ARM64E_KERNEL ||
+         format == ChainedFixups::PTR_ARM64E_USERLAND ||
+         format == ChainedFixups::PTR_ARM64E_USERLAND24;
+}
+
+inline uint64_t next_fixup(uint16_t format, uint64_t value) {
+  return is_arm64e(format) ? (value >> 51) & 0x7FF : (value >> 51) & 0xFFF;
+}
+
+//! Return true and the import ordinal if the given value is a bind
+inline bool is_bind(uint16_t format, uint64_t value, uint32_t& ordinal) {
+  if (is_arm64e(format)) {
+    ordinal = format == ChainedFixups::PTR_ARM64E_USERLAND24 ? value & 0xFFFFFF : value & 0xFFFF;
+    return (value >> 62) & 1;
+  }
+  ordinal = value & 0xFFFFFF;
+  return (value >> 63) & 1;
+}
+
+//! Symbols of the imports table
+static std::vector<std::string_view> read_imports(LIEF::span<const uint8_t> payload,
+                                                  const details::dyld_chained_fixups_header& hdr)
+{
+  const auto symbol = [&] (uint64_t name_offset) -> std::string_view {
+    const uint64_t offset = uint64_t(hdr.symbols_offset) + name_offset;
+    if (offset >= payload.size()) {
+      return {};
+    }
+    const auto* str = reinterpret_cast<const char*>(payload.data() + offset);
+    return std::string_view(str, strnlen(str, payload.size() - offset));
+  };
+
+  std::vector<std::string_view> imports;
+  imports.reserve(hdr.imports_count);
+  for (size_t i = 0; i < hdr.imports_count; ++i) {
+    switch (hdr.imports_format) {
+      case details::DYLD_CHAINED_IMPORT:
+      case details::DYLD_CHAINED_IMPORT_ADDEND:
+        {
+          const size_t sizeof_import = hdr.imports_format == details::DYLD_CHAINED_IMPORT ? 4 : 8;
+          uint32_t import = 0;
+          if (!peek(payload, hdr.imports_offset + i * sizeof_import, import)) {
+            return imports;
+          }
+          imports.push_back(symbol(import >> 9));
+          break;
+        }
+
+      case details::DYLD_CHAINED_IMPORT_ADDEND64:
+        {
+          uint64_t import = 0;
+          if (!peek(payload, hdr.imports_offset + i * 16, import)) {
+            return imports;
+          }
+          imports.push_back(symbol(import >> 32));
+          break;
+        }
+
+      default:
+        ICDUMP_WARN("Unsupported chained imports format: {}", hdr.imports_format);
+        return imports;
+    }
+  }
+  return imports;
+}
+
+std::unique_ptr<ChainedFixups> ChainedFixups::parse(LIEF::span<const uint8_t> payload,
+                                                    const MachOImage::segments_t& segments,
+                                                    uint64_t imagebase)
+{
+  details::dyld_chained_fixups_header hdr;
+  if (!peek(payload, 0, hdr)) {
+    ICDUMP_ERR("LC_DYLD_CHAINED_FIXUPS is corrupted");
+    return nullptr;
+  }
+
+  uint32_t seg_count = 0;
+  if (!peek(payload, hdr.starts_offset, seg_count)) {
+    ICDUMP_ERR("Can't read dyld_chained_starts_in_image");
+    return nullptr;
+  }
+
+  std::unique_ptr<ChainedFixups> fixups(new ChainedFixups{});
+  fixups->imagebase_ = imagebase;
+  const std::vector<std::string_view> imports = read_imports(payload, hdr);
+
+  for (size_t i = 0; i < seg_count && i < segments.size(); ++i) {
+    uint32_t seg_info_offset = 0;
+    if (!peek(payload, hdr.starts_offset + sizeof(uint32_t) * (i + 1), seg_info_offset)) {
+      break;
+    }
+    if (seg_info_offset == 0) {
+      continue;
+    }
+
+    const uint64_t starts_offset = uint64_t(hdr.starts_offset) + seg_info_offset;
+    details::dyld_chained_starts_in_segment starts;
+    if (!peek(payload, starts_offset, starts, details::SIZEOF_STARTS_IN_SEGMENT)) {
+      ICDUMP_WARN("Can't read dyld_chained_starts_in_segment of {}", segments[i].name);
+      continue;
+    }
+
+    const uint32_t step = stride(starts.pointer_format);
+    if (step == 0 || starts.page_size == 0) {
+      ICDUMP_WARN("Unsupported chained pointer format: {}", starts.pointer_format);
+      continue;
+    }
+
+    if (fixups->format_ == 0) {
+      fixups->format_ = starts.pointer_format;
+    } else if (fixups->format_ != starts.pointer_format) {
+      ICDUMP_WARN("{} uses a different pointer format ({})", segments[i].name, starts.pointer_format);
+    }
+
+    const MachOImage::segment_t& seg = segments[i];
+    segment_t& entry = fixups->segments_.emplace_back();
+    entry.start     = seg.virtual_address;
+    entry.end       = seg.virtual_address + seg.virtual_size;
+    entry.page_size = starts.page_size;
+    entry.pages.reserve(starts.page_count + 1);
+
+    for (size_t page = 0; page < starts.page_count; ++page) {
+      entry.pages.push_back(fixups->offsets_.size());
+      uint16_t page_start = details::DYLD_CHAINED_PTR_START_NONE;
+      if (!peek(payload, starts_offset + details::SIZEOF_STARTS_IN_SEGMENT + page * sizeof(uint16_t),
+                page_start))
+      {
+        break;
+      }
+
+      if (page_start == details::DYLD_CHAINED_PTR_START_NONE ||
+          (page_start & details::DYLD_CHAINED_PTR_START_MULTI) != 0)
+      {
+        continue;
+      }
+
+      const uint64_t page_offset = page * uint64_t(starts.page_size);
+      uint64_t offset = page_start;
+      while (offset < starts.page_size) {
+        uint64_t value = 0;
+        if (!peek(seg.content, page_offset + offset, value)) {
+          break;
+        }
+        fixups->offsets_.push_back(offset);
+
+        uint32_t ordinal = 0;
+        if (is_bind(starts.pointer_format, value, ordinal)) {
+          if (ordinal < imports.size() && !imports[ordinal].empty()) {
+            fixups->bindings_.push_back({seg.virtual_address + page_offset + offset, imports[ordinal]});
+          }
+        }
+
+        const uint64_t next = next_fixup(starts.pointer_format, value);
+        if (next == 0) {
+          break;
+        }
+        offset += next * step;
+      }
+    }
+    entry.pages.push_back(fixups->offsets_.size());
+  }
+
+  ICDUMP_DEBUG("Chained fixups: {} fixups, {} binds", fixups->offsets_.size(),
+               fixups->bindings_.size());
+  return fixups;
+}
+
+uint64_t ChainedFixups::decode(uint64_t value) const {
+  if (value == 0) {
+    return 0;
+  }
+
+  switch (format_) {
+    case PTR_64:
+    case PTR_64_OFFSET:
+      {
+        if ((value >> 63) & 1) {
+          return 0;
+        }
+        const uint64_t target = value & ((1llu << 36) - 1);
+        return format_ == PTR_64_OFFSET ? imagebase_ + target : target;
+      }
+
+    case PTR_ARM64E:
+    case PTR_ARM64E_KERNEL:
+    case PTR_ARM64E_USERLAND:
+    case PTR_ARM64E_USERLAND24:
+      {
+        const bool is_auth = (value >> 63) & 1;
+        if ((value >> 62) & 1) {
+          return 0;
+        }
+        // The authenticated pointers always target an offset in the image
+        if (is_auth) {
+          return imagebase_ + (value & 0xFFFFFFFF);
+        }
+        const uint64_t target = value & ((1llu << 43) - 1);
+        return format_ == PTR_ARM64E ? target : imagebase_ + target;
+      }
+  }
+  return value;
+}
+
+bool ChainedFixups::is_fixup(uint64_t address) const {
+  for (const segment_t& seg : segments_) {
+    if (address < seg.start || address >= seg.end) {
+      continue;
+    }
+    const uint64_t page = (address - seg.start) / seg.page_size;
+    if (page + 1 >= seg.pages.size()) {
+      return false;
+    }
+    const auto offset = static_cast<uint16_t>((address - seg.start) % seg.page_size);
+    const auto begin = offsets_.begin() + seg.pages[page];
+    const auto end   = offsets_.begin() + seg.pages[page + 1];
+    return std::binary_search(begin, end, offset);
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,95 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_CHAINED_FIXUPS_H_
+#define ICDUMP_CHAINED_FIXUPS_H_
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <LIEF/span.hpp>
+
+#include "iCDump/NonCopyable.hpp"
+#include "MachOImage.hpp"
+
+namespace iCDump {
+
+//! Decoded LC_DYLD_CHAINED_FIXUPS.
+//!
+//! The chains are walked once to build a per-page map of the fixup
+//! locations and to collect the binds. The pointers of the image can then
+//! be decoded exactly, according to the pointer format of the image, instead
+//! of being guessed. Once built, the object is read-only and it can be used
+//! concurrently.
+class ChainedFixups : protected NonCopyable {
+  public:
+  //! dyld_chained_ptr_format (only the 64-bits formats are supported)
+  enum PTR_FORMAT : uint16_t {
+    PTR_ARM64E            = 1,
+    PTR_64                = 2,
+    PTR_64_OFFSET         = 6,
+    PTR_ARM64E_KERNEL     = 7,
+    PTR_ARM64E_USERLAND   = 9,
+    PTR_ARM64E_USERLAND24 = 12,
+  };
+
+  //! Decode the payload of LC_DYLD_CHAINED_FIXUPS. ``segments`` must be
+  //! ordered as the LC_SEGMENT_64 commands and the symbols of the binds
+  //! reference ``payload``.
+  static std::unique_ptr<ChainedFixups> parse(LIEF::span<const uint8_t> payload,
+                                              const MachOImage::segments_t& segments,
+                                              uint64_t imagebase);
+
+  //! Address targeted by the given (raw) pointer value. The binds and
+  //! the null pointers are decoded as 0.
+  uint64_t decode(uint64_t value) const;
+
+  //! Check if a fixup is located at the given address
+  bool is_fixup(uint64_t address) const;
+
+  inline uint16_t pointer_format() const {
+    return format_;
+  }
+
+  //! Pointers bound to a symbol (located in the chains)
+  inline const MachOImage::bindings_t& bindings() const {
+    return bindings_;
+  }
+
+  //! Number of fixups (rebases and binds)
+  inline size_t size() const {
+    return offsets_.size();
+  }
+
+  private:
+  ChainedFixups() = default;
+
+  //! Fixups of a segment: the fixups of the page ``i`` are the
+  //! ``offsets_[pages[i] .. pages[i + 1])`` (sorted offsets in the page)
+  struct segment_t {
+    uint64_t start = 0;
+    uint64_t end   = 0;
+    uint32_t page_size = 0;
+    std::vector<uint32_t> pages;
+  };
+
+  uint16_t format_ = 0;
+  uint64_t imagebase_ = 0;
+  std::vector<segment_t> segments_;
+  std::vector<uint16_t> offsets_;
+  MachOImage::bindings_t bindings_;
+};
+}
+#endif
@@ -73,11 +73,8 @@ std::string pretty_struct(const std::string& sname) {
 
 
 ASTGen& ASTGen::get() {
-  if (instance_ == nullptr) {
-    instance_ = new ASTGen{};
-    std::atexit(destroy);
-  }
-  return *instance_;
+  thread_local std::unique_ptr<ASTGen> instance(new ASTGen{});
+  return *instance;
 }
 
 ASTGen::ASTGen() {
@@ -92,9 +89,7 @@ ASTGen::ASTGen() {
   ci_->createASTContext();
 }
 
-void ASTGen::destroy() {
-  delete instance_;
-}
+ASTGen::~ASTGen() = default;
 
 ASTContext& ASTGen::ast_ctx() {
   return ci_->getASTContext();
@@ -108,6 +103,20 @@ ObjCProtocolDecl* ASTGen::decl_protocol(const ObjC::Protocol& protocol, DeclCont
       SourceLocation(), SourceLocation(), nullptr);
   protocol_decl->startDefinition();
 
+  llvm::SmallVector<ObjCProtocolDecl*, 8> protocols;
+  llvm::SmallVector<SourceLocation, 8> source_locations;
+  for (const ObjC::Protocol& proto : protocol.protocols()) {
+    IdentifierInfo& id = ctx.Idents.get(proto.mangled_name());
+    auto inherited_decl = ObjCProtocolDecl::Create(
+        ctx, protocol_decl, &id,
+        SourceLocation(), SourceLocation(), nullptr);
+    protocols.push_back(inherited_decl);
+    source_locations.push_back(SourceLocation());
+  }
+  if (!protocols.empty()) {
+    protocol_decl->setProtocolList(protocols.data(), protocols.size(), source_locations.data(), ctx);
+  }
+
   for (const ObjC::Method& meth : protocol.optional_methods()) {
     ObjCMethodDecl* cmeth = decl_method(meth, protocol_decl);
     cmeth->setDeclImplementation(ObjCMethodDecl::ImplementationControl::Optional);
@@ -127,7 +136,7 @@ ObjCProtocolDecl* ASTGen::decl_protocol(const ObjC::Protocol& protocol, DeclCont
 }
 
 
-QualType get_qtype(ASTGen& gen, const ObjC::Type& t, DeclContext* DC) {
+QualType make_qtype(ASTGen& gen, const ObjC::Type& t, DeclContext* DC) {
   auto& ctx = gen.ast_ctx();
 
   switch (t.type) {
@@ -169,7 +178,7 @@ QualType get_qtype(ASTGen& gen, const ObjC::Type& t, DeclContext* DC) {
     case ObjC::OBJC_TYPES::POINTER:
       {
         const auto& pointer_ty = static_cast<const ObjC::PointerTy&>(t);
-        QualType utype = get_qtype(gen, *pointer_ty.subtype, DC);
+        QualType utype = gen.get_qtype(*pointer_ty.subtype, DC);
         return ctx.getPointerType(utype);
       }
 
@@ -231,7 +240,7 @@ QualType get_qtype(ASTGen& gen, const ObjC::Type& t, DeclContext* DC) {
             qt = ctx.VoidTy;
           }
         } else {
-          return get_qtype(gen, NSObject, DC);
+          return gen.get_qtype(NSObject, DC);
         }
         return ctx.getPointerType(qt);
       }
@@ -241,7 +250,7 @@ QualType get_qtype(ASTGen& gen, const ObjC::Type& t, DeclContext* DC) {
         const auto& array_ty = static_cast<const ObjC::ArrayTy&>(t);
         const llvm::APInt dim(sizeof(ObjC::ArrayTy::dim) * 8, array_ty.dim);
         return ctx.getConstantArrayType(
-            get_qtype(gen, *array_ty.subtype, DC), dim,
+            gen.get_qtype(*array_ty.subtype, DC), dim,
             nullptr, ArrayType::ArraySizeModifier::Normal, 0);
       }
 
@@ -286,12 +295,26 @@ QualType get_qtype(ASTGen& gen, const ObjC::Type& t, DeclContext* DC) {
   }
 }
 
+QualType ASTGen::get_qtype(const ObjC::Type& type, DeclContext* DC) {
+  const auto key = std::make_pair(&type, static_cast<const DeclContext*>(DC));
+  if (auto it = qtypes_.find(key); it != std::end(qtypes_)) {
+    return QualType::getFromOpaquePtr(it->second);
+  }
+  QualType qt = make_qtype(*this, type, DC);
+  qtypes_[key] = qt.getAsOpaquePtr();
+  return qt;
+}
+
+void ASTGen::reset_types() {
+  qtypes_.clear();
+}
+
 ObjCMethodDecl* ASTGen::decl_method(const ObjC::Method& meth, DeclContext* DC) {
   auto& ctx = ast_ctx();
   auto selector = GetUnarySelector(meth.name(), ctx);
 
-  ObjC::Method::prototype_t prototype = meth.prototype();
-  QualType rtype = get_qtype(*this, *prototype.rtype, DC);
+  const ObjC::Method::prototype_t& prototype = meth.prototype();
+  QualType rtype = get_qtype(*prototype.rtype, DC);
 
   auto clang_method = ObjCMethodDecl::Create(
       ctx, SourceLocation(), SourceLocation(),
@@ -310,16 +333,16 @@ ObjCMethodDecl* ASTGen::decl_method(const ObjC::Method& meth, DeclContext* DC) {
         qt = ctx.getObjCInterfaceType(llvm::cast<ObjCInterfaceDecl>(DC));
         qt = ctx.getPointerType(qt);
       } else {
-        qt = get_qtype(*this, *p, clang_method);
+        qt = get_qtype(*p, clang_method);
       }
     }
     else if (p->type == ObjC::OBJC_TYPES::SELECTOR) {
       arg_name = "id";
-      qt = get_qtype(*this, *p, clang_method);
+      qt = get_qtype(*p, clang_method);
     }
     else {
       arg_name = "arg" + std::to_string(i);
-      qt = get_qtype(*this, *p, clang_method);
+      qt = get_qtype(*p, clang_method);
     }
 
     auto* pdecl = ParmVarDecl::Create(
@@ -364,6 +387,12 @@ ObjCInterfaceDecl* ASTGen::decl_class(const ObjC::Class& cls, DeclContext* DC) {
     cls_decl->setProtocolList(protocols.data(), protocols.size(), source_locations.data(), ctx);
   }
 
+  if (const ObjC::Class* meta = cls.meta_class(); meta != nullptr && meta != &cls) {
+    for (const ObjC::Method& meth : meta->methods()) {
+      ObjCMethodDecl* cmeth = decl_method(meth, cls_decl);
+    }
+  }
+
   for (const ObjC::Method& meth : cls.methods()) {
     ObjCMethodDecl* cmeth = decl_method(meth, cls_decl);
   }
@@ -398,9 +427,9 @@ ObjCIvarDecl* ASTGen::decl_ivar(const ObjC::IVar& ivar, ObjCContainerDecl* DC) {
 
   QualType type;
   if (!ivar.mangled_type().empty()) {
-    std::unique_ptr<ObjC::Type> ivar_type = ivar.type();
+    const ObjC::Type* ivar_type = ivar.type();
     if (ivar_type != nullptr) {
-      type = get_qtype(*this, *ivar_type, DC);
+      type = get_qtype(*ivar_type, DC);
     } else {
       ICDUMP_ERR("Can't resolve type for ivar: {} ({})", ivar.name(), ivar.mangled_type());
       type = ctx.UnknownAnyTy;
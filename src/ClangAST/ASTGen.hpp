@@ -14,7 +14,9 @@
  */
 #ifndef ICDUMP_ASTGEN_H_
 #define ICDUMP_ASTGEN_H_
+#include <map>
 #include <memory>
+#include <utility>
 namespace clang {
 class ASTContext;
 class CompilerInstance;
@@ -36,6 +38,7 @@ class IVar;
 class Method;
 class Property;
 class Protocol;
+struct Type;
 }
 
 namespace ClangAST {
@@ -43,6 +46,9 @@ namespace ClangAST {
 // Wrapper over clang::ASTContext
 class ASTGen {
   public:
+  //! Generator of the calling thread. The CompilerInstance/ASTContext and
+  //! the memoized types are not thread-safe, so each thread that generates
+  //! declarations owns its own instance.
   static ASTGen& get();
 
   clang::ObjCProtocolDecl* decl_protocol(const ObjC::Protocol& protocol, clang::DeclContext* DC);
@@ -50,14 +56,25 @@ class ASTGen {
   clang::ObjCInterfaceDecl* decl_class(const ObjC::Class& cls, clang::DeclContext* DC);
   clang::ObjCPropertyDecl* decl_property(const ObjC::Property& prop, clang::DeclContext* DC);
   clang::ObjCIvarDecl* decl_ivar(const ObjC::IVar& ivar, clang::ObjCContainerDecl* DC);
+  //! Memoized translation of the given type. As the types are shared by the
+  //! TypeCache, a type is translated once per DeclContext. Like the rest of
+  //! the generator, the memo belongs to a single thread.
+  clang::QualType get_qtype(const ObjC::Type& type, clang::DeclContext* DC);
+
+  //! Forget the translated types (called for each new translation unit)
+  void reset_types();
+
   //clang::ParmVarDecl* decl_parameter(const ObjCMethod& protocol, clang::DeclContext* DC);
   clang::ASTContext& ast_ctx();
 
-  static void destroy();
+  ~ASTGen();
   private:
   ASTGen();
-  inline static ASTGen* instance_ = nullptr;
   std::unique_ptr<clang::CompilerInstance> ci_;
+
+  //! (type, DC) -> QualType::getAsOpaquePtr(). Not synchronized: it is only
+  //! reached through the thread_local instance returned by get().
+  std::map<std::pair<const ObjC::Type*, const clang::DeclContext*>, void*> qtypes_;
 };
 
 }
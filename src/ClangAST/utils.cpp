@@ -40,6 +40,8 @@ PrintingPolicy get_print_policy() {
 }
 
 void init_TU(ASTGen& gen, DeclContext* DC) {
+  // The memoized types reference the decls of the previous TU
+  gen.reset_types();
   //ASTContext& ctx = gen.ast_ctx();
   //IdentifierInfo& id = ctx.Idents.get("uint32_t");
   //auto x = TypedefDecl::Create(ctx, DC, SourceLocation(), SourceLocation(), &id, nullptr);
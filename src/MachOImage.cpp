@@ -0,0 +1,600 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstring>
+
+#include "LIEF/MachO.hpp"
+#include "ChainedFixups.hpp"
+#include "MachOImage.hpp"
+#include "log.hpp"
+
+namespace iCDump {
+
+namespace details {
+static constexpr uint32_t MH_MAGIC_64     = 0xfeedfacf;
+static constexpr uint32_t FAT_MAGIC       = 0xcafebabe;
+static constexpr uint32_t FAT_MAGIC_64    = 0xcafebabf;
+static constexpr uint32_t LC_SEGMENT_64   = 0x19;
+static constexpr uint32_t LC_FUNCTION_STARTS = 0x26;
+static constexpr uint32_t LC_DYLD_INFO       = 0x22;
+static constexpr uint32_t LC_DYLD_INFO_ONLY  = 0x80000022;
+static constexpr uint32_t LC_DYLD_CHAINED_FIXUPS = 0x80000034;
+
+static constexpr uint8_t BIND_OPCODE_MASK                             = 0xF0;
+static constexpr uint8_t BIND_IMMEDIATE_MASK                          = 0x0F;
+static constexpr uint8_t BIND_OPCODE_DONE                             = 0x00;
+static constexpr uint8_t BIND_OPCODE_SET_DYLIB_ORDINAL_IMM            = 0x10;
+static constexpr uint8_t BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB           = 0x20;
+static constexpr uint8_t BIND_OPCODE_SET_DYLIB_SPECIAL_IMM            = 0x30;
+static constexpr uint8_t BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM    = 0x40;
+static constexpr uint8_t BIND_OPCODE_SET_TYPE_IMM                     = 0x50;
+static constexpr uint8_t BIND_OPCODE_SET_ADDEND_SLEB                  = 0x60;
+static constexpr uint8_t BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB      = 0x70;
+static constexpr uint8_t BIND_OPCODE_ADD_ADDR_ULEB                    = 0x80;
+static constexpr uint8_t BIND_OPCODE_DO_BIND                          = 0x90;
+static constexpr uint8_t BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB            = 0xA0;
+static constexpr uint8_t BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED      = 0xB0;
+static constexpr uint8_t BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB = 0xC0;
+static constexpr uint8_t BIND_OPCODE_THREADED                         = 0xD0;
+
+struct mach_header_64 {
+  uint32_t magic;
+  uint32_t cputype;
+  uint32_t cpusubtype;
+  uint32_t filetype;
+  uint32_t ncmds;
+  uint32_t sizeofcmds;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+struct load_command {
+  uint32_t cmd;
+  uint32_t cmdsize;
+};
+
+struct segment_command_64 {
+  uint32_t cmd;
+  uint32_t cmdsize;
+  char     segname[16];
+  uint64_t vmaddr;
+  uint64_t vmsize;
+  uint64_t fileoff;
+  uint64_t filesize;
+  uint32_t maxprot;
+  uint32_t initprot;
+  uint32_t nsects;
+  uint32_t flags;
+};
+
+struct linkedit_data_command {
+  uint32_t cmd;
+  uint32_t cmdsize;
+  uint32_t dataoff;
+  uint32_t datasize;
+};
+
+struct dyld_info_command {
+  uint32_t cmd;
+  uint32_t cmdsize;
+  uint32_t rebase_off;
+  uint32_t rebase_size;
+  uint32_t bind_off;
+  uint32_t bind_size;
+  uint32_t weak_bind_off;
+  uint32_t weak_bind_size;
+  uint32_t lazy_bind_off;
+  uint32_t lazy_bind_size;
+  uint32_t export_off;
+  uint32_t export_size;
+};
+
+struct section_64 {
+  char     sectname[16];
+  char     segname[16];
+  uint64_t addr;
+  uint64_t size;
+  uint32_t offset;
+  uint32_t align;
+  uint32_t reloff;
+  uint32_t nreloc;
+  uint32_t flags;
+  uint32_t reserved1;
+  uint32_t reserved2;
+  uint32_t reserved3;
+};
+
+// FAT structures are stored in big-endian
+struct fat_header {
+  uint32_t magic;
+  uint32_t nfat_arch;
+};
+
+struct fat_arch {
+  uint32_t cputype;
+  uint32_t cpusubtype;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t align;
+};
+
+struct fat_arch_64 {
+  uint32_t cputype;
+  uint32_t cpusubtype;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t align;
+  uint32_t reserved;
+};
+}
+
+template<class T>
+static bool peek(LIEF::span<const uint8_t> raw, uint64_t offset, T& out) {
+  if (offset > raw.size() || raw.size() - offset < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&out, raw.data() + offset, sizeof(T));
+  return true;
+}
+
+//! Decode the LEB128 value at ``pos`` (stopping at the end of the buffer)
+inline uint64_t read_uleb128(LIEF::span<const uint8_t> raw, size_t& pos) {
+  uint64_t value = 0;
+  uint32_t shift = 0;
+  while (pos < raw.size()) {
+    const uint8_t byte = raw[pos++];
+    if (shift < 64) {
+      value |= uint64_t(byte & 0x7f) << shift;
+    }
+    shift += 7;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+  return value;
+}
+
+inline int64_t read_sleb128(LIEF::span<const uint8_t> raw, size_t& pos) {
+  int64_t value = 0;
+  uint32_t shift = 0;
+  uint8_t byte = 0;
+  while (pos < raw.size()) {
+    byte = raw[pos++];
+    if (shift < 64) {
+      value |= int64_t(byte & 0x7f) << shift;
+    }
+    shift += 7;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+  if (shift < 64 && (byte & 0x40) != 0) {
+    value |= -(int64_t(1) << shift);
+  }
+  return value;
+}
+
+//! Decode the ULEB128-encoded deltas of LC_FUNCTION_STARTS. The first
+//! delta is relative to the start of __TEXT.
+static std::vector<uint64_t> decode_function_starts(LIEF::span<const uint8_t> raw, uint64_t text_base) {
+  std::vector<uint64_t> functions;
+  uint64_t address = text_base;
+  size_t pos = 0;
+  while (pos < raw.size()) {
+    const uint64_t delta = read_uleb128(raw, pos);
+    if (delta == 0) {
+      break;
+    }
+    address += delta;
+    functions.push_back(address);
+  }
+  return functions;
+}
+
+//! Run the bind opcodes of LC_DYLD_INFO and append the bound locations.
+//! The symbols reference the opcodes' buffer.
+static void decode_bindings(LIEF::span<const uint8_t> raw, const MachOImage::segments_t& segments,
+                            MachOImage::bindings_t& bindings)
+{
+  std::string_view symbol;
+  uint64_t address = 0;
+  uint64_t seg_end = 0;
+  size_t pos = 0;
+
+  // Return false if the location is outside of the current segment
+  const auto bind = [&] {
+    if (address >= seg_end) {
+      return false;
+    }
+    if (!symbol.empty()) {
+      bindings.push_back({address, symbol});
+    }
+    address += sizeof(uint64_t);
+    return true;
+  };
+
+  while (pos < raw.size()) {
+    const uint8_t opcode = raw[pos] & details::BIND_OPCODE_MASK;
+    const uint8_t imm    = raw[pos] & details::BIND_IMMEDIATE_MASK;
+    ++pos;
+    switch (opcode) {
+      case details::BIND_OPCODE_DONE:
+      case details::BIND_OPCODE_SET_DYLIB_ORDINAL_IMM:
+      case details::BIND_OPCODE_SET_DYLIB_SPECIAL_IMM:
+      case details::BIND_OPCODE_SET_TYPE_IMM:
+        break;
+
+      case details::BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB:
+        read_uleb128(raw, pos);
+        break;
+
+      case details::BIND_OPCODE_SET_ADDEND_SLEB:
+        read_sleb128(raw, pos);
+        break;
+
+      case details::BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM:
+        {
+          const auto* str = reinterpret_cast<const char*>(raw.data() + pos);
+          const size_t len = strnlen(str, raw.size() - pos);
+          symbol = std::string_view(str, len);
+          pos += len + 1;
+          break;
+        }
+
+      case details::BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB:
+        {
+          const uint64_t offset = read_uleb128(raw, pos);
+          if (imm >= segments.size()) {
+            ICDUMP_WARN("Bind opcodes: invalid segment index #{}", imm);
+            return;
+          }
+          address = segments[imm].virtual_address + offset;
+          seg_end = segments[imm].virtual_address + segments[imm].virtual_size;
+          break;
+        }
+
+      case details::BIND_OPCODE_ADD_ADDR_ULEB:
+        address += read_uleb128(raw, pos);
+        break;
+
+      case details::BIND_OPCODE_DO_BIND:
+        bind();
+        break;
+
+      case details::BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB:
+        bind();
+        address += read_uleb128(raw, pos);
+        break;
+
+      case details::BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED:
+        bind();
+        address += imm * sizeof(uint64_t);
+        break;
+
+      case details::BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB:
+        {
+          const uint64_t count = read_uleb128(raw, pos);
+          const uint64_t skip  = read_uleb128(raw, pos);
+          for (uint64_t i = 0; i < count && bind(); ++i) {
+            address += skip;
+          }
+          break;
+        }
+
+      case details::BIND_OPCODE_THREADED:
+        // Binds located in the rebase chains (arm64e before chained fixups)
+        ICDUMP_WARN("Threaded bind opcodes are not supported");
+        return;
+
+      default:
+        ICDUMP_WARN("Unknown bind opcode: 0x{:02x}", opcode);
+        return;
+    }
+  }
+}
+
+inline std::string fixed_str(const char (&str)[16]) {
+  return std::string(str, strnlen(str, sizeof(str)));
+}
+
+//! Sections used by the ObjC parser: the __objc_* sections and
+//! the C-string pool
+inline bool is_objc_section(const std::string& name) {
+  return name.rfind("__objc_", 0) == 0 || name == "__cstring";
+}
+
+bool MachOImage::is_macho(LIEF::span<const uint8_t> raw) {
+  uint32_t magic = 0;
+  if (!peek(raw, 0, magic)) {
+    return false;
+  }
+  return magic == details::MH_MAGIC_64 ||
+         __builtin_bswap32(magic) == details::FAT_MAGIC ||
+         __builtin_bswap32(magic) == details::FAT_MAGIC_64;
+}
+
+MachOImage::slices_t MachOImage::slices(LIEF::span<const uint8_t> raw) {
+  details::fat_header fat_hdr;
+  if (!peek(raw, 0, fat_hdr)) {
+    ICDUMP_ERR("File too small to be a Mach-O");
+    return {};
+  }
+
+  const uint32_t magic = __builtin_bswap32(fat_hdr.magic);
+  if (magic != details::FAT_MAGIC && magic != details::FAT_MAGIC_64) {
+    details::mach_header_64 hdr;
+    if (!peek(raw, 0, hdr) || hdr.magic != details::MH_MAGIC_64) {
+      ICDUMP_ERR("Unsupported Mach-O format (magic: 0x{:08x})", fat_hdr.magic);
+      return {};
+    }
+    return {{hdr.cputype, hdr.cpusubtype, raw}};
+  }
+
+  const bool is64 = magic == details::FAT_MAGIC_64;
+  const uint32_t nb_arch = __builtin_bswap32(fat_hdr.nfat_arch);
+  uint64_t offset = sizeof(details::fat_header);
+
+  slices_t slices;
+  for (size_t i = 0; i < nb_arch; ++i) {
+    slice_t slice;
+    uint64_t slice_offset = 0;
+    uint64_t slice_size   = 0;
+    if (is64) {
+      details::fat_arch_64 arch;
+      if (!peek(raw, offset, arch)) {
+        ICDUMP_ERR("Can't read fat_arch_64[{}]", i);
+        break;
+      }
+      slice.cpu_type    = __builtin_bswap32(arch.cputype);
+      slice.cpu_subtype = __builtin_bswap32(arch.cpusubtype);
+      slice_offset      = __builtin_bswap64(arch.offset);
+      slice_size        = __builtin_bswap64(arch.size);
+      offset += sizeof(details::fat_arch_64);
+    } else {
+      details::fat_arch arch;
+      if (!peek(raw, offset, arch)) {
+        ICDUMP_ERR("Can't read fat_arch[{}]", i);
+        break;
+      }
+      slice.cpu_type    = __builtin_bswap32(arch.cputype);
+      slice.cpu_subtype = __builtin_bswap32(arch.cpusubtype);
+      slice_offset      = __builtin_bswap32(arch.offset);
+      slice_size        = __builtin_bswap32(arch.size);
+      offset += sizeof(details::fat_arch);
+    }
+
+    if (slice_offset > raw.size() || raw.size() - slice_offset < slice_size) {
+      ICDUMP_WARN("fat_arch[{}] is out of bounds", i);
+      continue;
+    }
+    slice.content = raw.subspan(slice_offset, slice_size);
+    slices.push_back(slice);
+  }
+  return slices;
+}
+
+std::unique_ptr<MachOImage> MachOImage::parse(const slice_t& slice) {
+  LIEF::span<const uint8_t> raw = slice.content;
+  details::mach_header_64 hdr;
+  if (!peek(raw, 0, hdr) || hdr.magic != details::MH_MAGIC_64) {
+    ICDUMP_ERR("Only 64-bits Mach-O are supported");
+    return nullptr;
+  }
+
+  std::unique_ptr<MachOImage> image(new MachOImage{});
+  image->cpu_type_    = hdr.cputype;
+  image->cpu_subtype_ = hdr.cpusubtype;
+
+  LIEF::span<const uint8_t> function_starts;
+  LIEF::span<const uint8_t> binds;
+  LIEF::span<const uint8_t> weak_binds;
+  LIEF::span<const uint8_t> chained_fixups;
+  uint64_t offset = sizeof(details::mach_header_64);
+  for (size_t i = 0; i < hdr.ncmds; ++i) {
+    details::load_command lc;
+    if (!peek(raw, offset, lc) || lc.cmdsize < sizeof(details::load_command)) {
+      ICDUMP_ERR("Load command #{} is corrupted", i);
+      return nullptr;
+    }
+
+    if (lc.cmd == details::LC_FUNCTION_STARTS) {
+      details::linkedit_data_command cmd;
+      if (peek(raw, offset, cmd) && cmd.dataoff <= raw.size() &&
+          raw.size() - cmd.dataoff >= cmd.datasize)
+      {
+        function_starts = raw.subspan(cmd.dataoff, cmd.datasize);
+      } else {
+        ICDUMP_WARN("LC_FUNCTION_STARTS is corrupted");
+      }
+    }
+
+    if (lc.cmd == details::LC_DYLD_CHAINED_FIXUPS) {
+      details::linkedit_data_command cmd;
+      if (peek(raw, offset, cmd) && cmd.dataoff <= raw.size() &&
+          raw.size() - cmd.dataoff >= cmd.datasize)
+      {
+        chained_fixups = raw.subspan(cmd.dataoff, cmd.datasize);
+      } else {
+        ICDUMP_WARN("LC_DYLD_CHAINED_FIXUPS is corrupted");
+      }
+    }
+
+    if (lc.cmd == details::LC_DYLD_INFO || lc.cmd == details::LC_DYLD_INFO_ONLY) {
+      details::dyld_info_command cmd;
+      if (!peek(raw, offset, cmd)) {
+        ICDUMP_WARN("LC_DYLD_INFO is corrupted");
+      } else {
+        if (cmd.bind_off <= raw.size() && raw.size() - cmd.bind_off >= cmd.bind_size) {
+          binds = raw.subspan(cmd.bind_off, cmd.bind_size);
+        }
+        if (cmd.weak_bind_off <= raw.size() && raw.size() - cmd.weak_bind_off >= cmd.weak_bind_size) {
+          weak_binds = raw.subspan(cmd.weak_bind_off, cmd.weak_bind_size);
+        }
+      }
+    }
+
+    if (lc.cmd == details::LC_SEGMENT_64) {
+      details::segment_command_64 raw_seg;
+      if (!peek(raw, offset, raw_seg)) {
+        ICDUMP_ERR("Can't read segment_command_64 at 0x{:x}", offset);
+        return nullptr;
+      }
+
+      segment_t& seg = image->segments_.emplace_back();
+      seg.name            = fixed_str(raw_seg.segname);
+      seg.virtual_address = raw_seg.vmaddr;
+      seg.virtual_size    = raw_seg.vmsize;
+      seg.file_offset     = raw_seg.fileoff;
+      seg.file_size       = raw_seg.filesize;
+      if (raw_seg.fileoff <= raw.size()) {
+        seg.content = raw.subspan(raw_seg.fileoff,
+                                  std::min<uint64_t>(raw_seg.filesize, raw.size() - raw_seg.fileoff));
+      } else {
+        ICDUMP_WARN("Segment {} is out of bounds", seg.name);
+      }
+
+      if (seg.name == "__TEXT") {
+        image->imagebase_ = seg.virtual_address;
+      }
+
+      uint64_t sec_offset = offset + sizeof(details::segment_command_64);
+      for (size_t j = 0; j < raw_seg.nsects; ++j) {
+        details::section_64 raw_sec;
+        if (!peek(raw, sec_offset, raw_sec)) {
+          ICDUMP_ERR("Can't read section_64[{}] of {}", j, seg.name);
+          break;
+        }
+        sec_offset += sizeof(details::section_64);
+
+        std::string name = fixed_str(raw_sec.sectname);
+        if (!is_objc_section(name)) {
+          continue;
+        }
+
+        section_t& sec = image->sections_.emplace_back();
+        sec.segment_name    = fixed_str(raw_sec.segname);
+        sec.name            = std::move(name);
+        sec.virtual_address = raw_sec.addr;
+        sec.size            = raw_sec.size;
+        if (raw_sec.offset <= raw.size()) {
+          sec.content = raw.subspan(raw_sec.offset,
+                                    std::min<uint64_t>(raw_sec.size, raw.size() - raw_sec.offset));
+        }
+      }
+    }
+    offset += lc.cmdsize;
+  }
+
+  // Decoded once all the segments are known (__TEXT is the base)
+  image->function_starts_ = decode_function_starts(function_starts, image->imagebase_);
+  decode_bindings(binds, image->segments_, image->bindings_);
+  decode_bindings(weak_binds, image->segments_, image->bindings_);
+  image->set_chained_fixups(chained_fixups);
+  return image;
+}
+
+std::unique_ptr<MachOImage> MachOImage::from_binary(const LIEF::MachO::Binary& bin) {
+  std::unique_ptr<MachOImage> image(new MachOImage{});
+  image->cpu_type_    = static_cast<uint32_t>(bin.header().cpu_type());
+  image->cpu_subtype_ = bin.header().cpu_subtype();
+  image->imagebase_   = bin.imagebase();
+  image->memory_base_address_ = bin.memory_base_address();
+
+  for (const LIEF::MachO::SegmentCommand& segment : bin.segments()) {
+    segment_t& seg = image->segments_.emplace_back();
+    seg.name            = segment.name();
+    seg.virtual_address = segment.virtual_address();
+    seg.virtual_size    = segment.virtual_size();
+    seg.file_offset     = segment.file_offset();
+    seg.file_size       = segment.file_size();
+    seg.content         = segment.content();
+  }
+
+  for (const LIEF::MachO::Section& section : bin.sections()) {
+    if (!is_objc_section(section.name())) {
+      continue;
+    }
+    section_t& sec = image->sections_.emplace_back();
+    sec.segment_name    = section.segment_name();
+    sec.name            = section.name();
+    sec.virtual_address = section.virtual_address();
+    sec.size            = section.size();
+    sec.content         = section.content();
+  }
+
+  if (const LIEF::MachO::DyldInfo* info = bin.dyld_info()) {
+    for (const LIEF::MachO::DyldBindingInfo& binding : info->bindings()) {
+      if (binding.has_symbol()) {
+        image->bindings_.push_back({binding.address(), binding.symbol()->name()});
+      }
+    }
+  }
+
+  // The chains are decoded from the raw payload (in __LINKEDIT)
+  if (const LIEF::MachO::DyldChainedFixups* fixups = bin.dyld_chained_fixups()) {
+    const uint64_t dataoff = fixups->data_offset();
+    for (const segment_t& seg : image->segments_) {
+      if (seg.file_offset <= dataoff && dataoff - seg.file_offset < seg.content.size()) {
+        const uint64_t offset = dataoff - seg.file_offset;
+        image->set_chained_fixups(
+          seg.content.subspan(offset, std::min<uint64_t>(fixups->data_size(), seg.content.size() - offset)));
+        break;
+      }
+    }
+  }
+
+  if (const LIEF::MachO::FunctionStarts* starts = bin.function_starts()) {
+    // LIEF provides the offsets relative to __TEXT
+    for (uint64_t offset : starts->functions()) {
+      image->function_starts_.push_back(image->imagebase_ + offset);
+    }
+    std::sort(image->function_starts_.begin(), image->function_starts_.end());
+  }
+  return image;
+}
+
+MachOImage::~MachOImage() = default;
+
+void MachOImage::set_chained_fixups(LIEF::span<const uint8_t> payload) {
+  if (payload.empty()) {
+    return;
+  }
+  chained_fixups_ = ChainedFixups::parse(payload, segments_, imagebase_);
+  if (chained_fixups_ != nullptr) {
+    const bindings_t& bindings = chained_fixups_->bindings();
+    bindings_.insert(bindings_.end(), bindings.begin(), bindings.end());
+  }
+}
+
+const MachOImage::section_t* MachOImage::get_section(const std::string& segname,
+                                                     const std::string& name) const {
+  for (const section_t& sec : sections_) {
+    if (sec.name == name && sec.segment_name == segname) {
+      return &sec;
+    }
+  }
+  return nullptr;
+}
+
+const MachOImage::segment_t* MachOImage::segment_from_virtual_address(uint64_t address) const {
+  for (const segment_t& seg : segments_) {
+    if (seg.virtual_address <= address && address < seg.virtual_address + seg.virtual_size) {
+      return &seg;
+    }
+  }
+  return nullptr;
+}
+
+}
@@ -0,0 +1,157 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_MACHO_IMAGE_H_
+#define ICDUMP_MACHO_IMAGE_H_
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LIEF/span.hpp>
+
+namespace LIEF::MachO {
+class Binary;
+}
+
+namespace iCDump {
+class ChainedFixups;
+
+//! Minimal view over a Mach-O slice which only exposes the segments and the
+//! sections required by the ObjC parser (__objc_* and __cstring).
+//!
+//! It can be built either from a fully-parsed LIEF binary or by walking
+//! the load commands of a raw slice (which avoids LIEF's dyld info processing)
+class MachOImage {
+  public:
+  static constexpr uint32_t CPU_TYPE_X86    = 7;
+  static constexpr uint32_t CPU_TYPE_ARM    = 12;
+  static constexpr uint32_t CPU_TYPE_X86_64 = CPU_TYPE_X86 | 0x01000000;
+  static constexpr uint32_t CPU_TYPE_ARM64  = CPU_TYPE_ARM | 0x01000000;
+
+  //! For images created with MachOImage::parse, ``content`` is a view on the
+  //! raw slice (i.e. the file mapping) located at ``file_offset``
+  struct segment_t {
+    std::string name;
+    uint64_t virtual_address = 0;
+    uint64_t virtual_size    = 0;
+    uint64_t file_offset     = 0;
+    uint64_t file_size       = 0;
+    LIEF::span<const uint8_t> content;
+  };
+
+  struct section_t {
+    std::string segment_name;
+    std::string name;
+    uint64_t virtual_address = 0;
+    uint64_t size            = 0;
+    LIEF::span<const uint8_t> content;
+  };
+
+  //! Pointer bound by dyld to a symbol of another image
+  struct binding_t {
+    uint64_t address = 0;
+    std::string_view symbol;
+  };
+
+  //! Architecture slice of a (FAT) Mach-O file
+  struct slice_t {
+    uint32_t cpu_type    = 0;
+    uint32_t cpu_subtype = 0;
+    LIEF::span<const uint8_t> content;
+  };
+
+  using segments_t = std::vector<segment_t>;
+  using sections_t = std::vector<section_t>;
+  using slices_t   = std::vector<slice_t>;
+  using bindings_t = std::vector<binding_t>;
+
+  MachOImage(const MachOImage&) = delete;
+  MachOImage& operator=(const MachOImage&) = delete;
+  ~MachOImage();
+
+  //! Check if the buffer starts with a 64-bits Mach-O or a FAT magic
+  static bool is_macho(LIEF::span<const uint8_t> raw);
+
+  //! Split the given raw buffer into its architecture slices. A thin Mach-O
+  //! file is returned as a single slice.
+  static slices_t slices(LIEF::span<const uint8_t> raw);
+
+  //! Create an image by only walking the load commands of the given slice.
+  //! The slice's buffer must outlive the image.
+  static std::unique_ptr<MachOImage> parse(const slice_t& slice);
+
+  //! Create an image from a binary already parsed by LIEF. The binary must
+  //! outlive the image.
+  static std::unique_ptr<MachOImage> from_binary(const LIEF::MachO::Binary& bin);
+
+  const section_t* get_section(const std::string& segname, const std::string& name) const;
+  const segment_t* segment_from_virtual_address(uint64_t address) const;
+
+  inline const segments_t& segments() const {
+    return segments_;
+  }
+
+  inline const sections_t& sections() const {
+    return sections_;
+  }
+
+  //! Pointers bound to a symbol (LC_DYLD_INFO and LC_DYLD_CHAINED_FIXUPS).
+  //! The symbols are owned by the binary or the raw slice.
+  inline const bindings_t& bindings() const {
+    return bindings_;
+  }
+
+  //! Decoded LC_DYLD_CHAINED_FIXUPS (nullptr if the image doesn't use them)
+  inline const ChainedFixups* chained_fixups() const {
+    return chained_fixups_.get();
+  }
+
+  //! Sorted addresses of the functions listed in LC_FUNCTION_STARTS
+  inline const std::vector<uint64_t>& function_starts() const {
+    return function_starts_;
+  }
+
+  inline uint64_t imagebase() const {
+    return imagebase_;
+  }
+
+  inline uint64_t memory_base_address() const {
+    return memory_base_address_;
+  }
+
+  inline uint32_t cpu_type() const {
+    return cpu_type_;
+  }
+
+  inline uint32_t cpu_subtype() const {
+    return cpu_subtype_;
+  }
+
+  private:
+  MachOImage() = default;
+  void set_chained_fixups(LIEF::span<const uint8_t> payload);
+
+  uint32_t cpu_type_    = 0;
+  uint32_t cpu_subtype_ = 0;
+  uint64_t imagebase_   = 0;
+  uint64_t memory_base_address_ = 0;
+  segments_t segments_;
+  sections_t sections_;
+  std::vector<uint64_t> function_starts_;
+  bindings_t bindings_;
+  std::unique_ptr<ChainedFixups> chained_fixups_;
+};
+}
+#endif
@@ -0,0 +1,117 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "MachOReader.hpp"
+#include "MachOImage.hpp"
+#include "log.hpp"
+
+namespace iCDump {
+
+MachOReader::MachOReader(const MachOImage& image) :
+  image_{&image},
+  memory_base_address_{image.memory_base_address()},
+  imagebase_{image.imagebase()}
+{
+  for (const MachOImage::segment_t& seg : image.segments()) {
+    if (seg.content.empty()) {
+      continue;
+    }
+    ranges_.push_back({
+      seg.virtual_address,
+      seg.virtual_address + seg.content.size(),
+      seg.content.data()
+    });
+  }
+
+  std::sort(std::begin(ranges_), std::end(ranges_),
+            [] (const range_t& lhs, const range_t& rhs) {
+              return lhs.start < rhs.start;
+            });
+
+  if (!ranges_.empty()) {
+    size_ = ranges_.back().end;
+    if (memory_base_address_ > 0) {
+      size_ = size_ - imagebase_ + memory_base_address_;
+    }
+  }
+}
+
+uint64_t MachOReader::size() const {
+  return size_;
+}
+
+const MachOReader::range_t* MachOReader::find_range(uint64_t address) const {
+  if (ranges_.empty()) {
+    return nullptr;
+  }
+
+  const size_t last = last_.load(std::memory_order_relaxed);
+  if (const range_t& range = ranges_[last]; range.start <= address && address < range.end) {
+    return &range;
+  }
+
+  auto it = std::upper_bound(std::begin(ranges_), std::end(ranges_), address,
+                             [] (uint64_t addr, const range_t& range) {
+                               return addr < range.start;
+                             });
+  if (it == std::begin(ranges_)) {
+    return nullptr;
+  }
+  --it;
+  if (address >= it->end) {
+    return nullptr;
+  }
+  last_.store(std::distance(std::begin(ranges_), it), std::memory_order_relaxed);
+  return &*it;
+}
+
+const uint8_t* MachOReader::data_at(uint64_t address, uint64_t size) const {
+  const uint64_t r_address = translate(address);
+
+  // The segment's content is either owned by LIEF or a view on the file
+  // mapping (in which case no data is copied)
+  const range_t* range = find_range(r_address);
+  if (range == nullptr) {
+    ICDUMP_DEBUG("Can't find segment with address: 0x{:010x}", r_address);
+    return nullptr;
+  }
+
+  if (range->end - r_address < size) {
+    ICDUMP_DEBUG("0x{:010x} is not backed by the file content", r_address);
+    return nullptr;
+  }
+  return range->data + (r_address - range->start);
+}
+
+LIEF::result<std::string_view> MachOReader::cstring_at(uint64_t address) const {
+  const uint64_t r_address = translate(address);
+  const range_t* range = find_range(r_address);
+  if (range == nullptr) {
+    ICDUMP_DEBUG("Can't find segment with address: 0x{:010x}", r_address);
+    return make_error_code(lief_errors::read_error);
+  }
+
+  const auto* str = reinterpret_cast<const char*>(range->data + (r_address - range->start));
+  const size_t max_len = range->end - r_address;
+  const auto* end = static_cast<const char*>(std::memchr(str, '\0', max_len));
+  if (end == nullptr) {
+    ICDUMP_DEBUG("String at 0x{:010x} is not terminated", r_address);
+    return make_error_code(lief_errors::read_error);
+  }
+  return std::string_view(str, end - str);
+}
+}
@@ -0,0 +1,97 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_MACHO_READER_H_
+#define ICDUMP_MACHO_READER_H_
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LIEF/errors.hpp>
+
+namespace iCDump {
+class MachOImage;
+
+//! Position-free reader over the virtual address space of a MachOImage.
+//!
+//! All the accessors are const and thread-safe: they can be used
+//! concurrently to decode the ObjC metadata of a single image.
+class MachOReader {
+  public:
+  MachOReader(const MachOImage& image);
+
+  MachOReader(const MachOReader&) = delete;
+  MachOReader& operator=(const MachOReader&) = delete;
+
+  //! Return a pointer to the ``size`` bytes located at the given virtual
+  //! address or a nullptr if they are not backed by the file
+  const uint8_t* data_at(uint64_t address, uint64_t size) const;
+
+  template<class T>
+  LIEF::result<T> read(uint64_t address) const {
+    const uint8_t* data = data_at(address, sizeof(T));
+    if (data == nullptr) {
+      return make_error_code(lief_errors::read_error);
+    }
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+  }
+
+  //! Return a view on the NUL-terminated string located at the given virtual
+  //! address. The view points into the image's content.
+  LIEF::result<std::string_view> cstring_at(uint64_t address) const;
+
+  //! End of the highest file-backed virtual address
+  uint64_t size() const;
+
+  inline const MachOImage& image() const {
+    return *image_;
+  }
+
+  //! Translate the address if the image is loaded at memory_base_address
+  inline uint64_t translate(uint64_t address) const {
+    if (memory_base_address_ > 0 && address > memory_base_address_) {
+      return address - memory_base_address_ + imagebase_;
+    }
+    return address;
+  }
+
+  private:
+  //! File-backed virtual address range [start, end)
+  struct range_t {
+    uint64_t start = 0;
+    uint64_t end   = 0;
+    const uint8_t* data = nullptr;
+  };
+
+  const range_t* find_range(uint64_t address) const;
+
+  const MachOImage* image_ = nullptr;
+
+  //! Ranges sorted by start address
+  std::vector<range_t> ranges_;
+
+  //! Index in ranges_ of the last successful lookup. Consecutive reads
+  //! usually hit the same segment (it is only a hint, hence relaxed)
+  mutable std::atomic<size_t> last_{0};
+
+  uint64_t memory_base_address_ = 0;
+  uint64_t imagebase_ = 0;
+  uint64_t size_ = 0;
+};
+}
+#endif
@@ -0,0 +1,66 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MemoryMap.hpp"
+#include "log.hpp"
+
+namespace iCDump {
+
+MemoryMap::MemoryMap(const uint8_t* data, size_t size) :
+  data_{data},
+  size_{size}
+{}
+
+MemoryMap::~MemoryMap() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+std::unique_ptr<MemoryMap> MemoryMap::open(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    ICDUMP_ERR("Can't open {}", path);
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ICDUMP_ERR("Can't get the size of {}", path);
+    close(fd);
+    return nullptr;
+  }
+
+  const auto size = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference on the file
+  close(fd);
+
+  if (addr == MAP_FAILED) {
+    ICDUMP_ERR("Can't mmap {}", path);
+    return nullptr;
+  }
+
+  // The ObjC metadata are scattered across the file: disable the read-ahead
+  // so that only the accessed pages are loaded.
+  madvise(addr, size, MADV_RANDOM);
+
+  return std::unique_ptr<MemoryMap>(new MemoryMap(static_cast<const uint8_t*>(addr), size));
+}
+}
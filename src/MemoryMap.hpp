@@ -0,0 +1,48 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_MEMORY_MAP_H_
+#define ICDUMP_MEMORY_MAP_H_
+#include <memory>
+#include <string>
+
+#include <LIEF/span.hpp>
+
+#include "iCDump/NonCopyable.hpp"
+
+namespace iCDump {
+
+//! Read-only memory mapping of a file. Pages are only loaded when accessed
+//! so that the resident memory matches what the parser actually touches.
+class MemoryMap : protected NonCopyable {
+  public:
+  static std::unique_ptr<MemoryMap> open(const std::string& path);
+
+  ~MemoryMap();
+
+  inline LIEF::span<const uint8_t> content() const {
+    return {data_, size_};
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+  private:
+  MemoryMap(const uint8_t* data, size_t size);
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+}
+#endif
@@ -0,0 +1,68 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "iCDump/ObjC/Category.hpp"
+#include "iCDump/ObjC/Method.hpp"
+#include "iCDump/ObjC/Parser.hpp"
+#include "iCDump/ObjC/Types.hpp"
+#include "log.hpp"
+
+#include "iCDump/Arena.hpp"
+#include "MachOReader.hpp"
+
+namespace iCDump::ObjC {
+
+Category* Category::create(Parser& parser, uintptr_t address) {
+  const auto raw_cat = parser.reader().read<ObjC::category_t>(address);
+  if (!raw_cat) {
+    ICDUMP_ERR("Can't read category_t at 0x{:x}", address);
+    return nullptr;
+  }
+
+  auto cat = parser.arena().make<Category>();
+  if (auto res = parser.string_at(parser.decode_ptr(raw_cat->name))) {
+    cat->name_ = *res;
+  }
+
+  ICDUMP_DEBUG("Processing category {}", cat->name_);
+
+  // The class (category_t.cls) is resolved by the Parser
+
+  if (raw_cat->instance_methods) {
+    const std::vector<Method*> methods =
+      parser.read_methods(parser.decode_ptr(raw_cat->instance_methods), /* is_instance */true);
+    cat->instance_methods_ = parser.arena().copy(methods);
+  }
+
+  if (raw_cat->class_methods) {
+    const std::vector<Method*> methods =
+      parser.read_methods(parser.decode_ptr(raw_cat->class_methods), /* is_instance */false);
+    cat->class_methods_ = parser.arena().copy(methods);
+  }
+
+  if (raw_cat->protocols) {
+    cat->protocols_ = parser.get_or_create_protocols(parser.decode_ptr(raw_cat->protocols));
+  }
+
+  if (raw_cat->instance_properties) {
+    cat->properties_ = parser.read_properties(parser.decode_ptr(raw_cat->instance_properties));
+  }
+  return cat;
+}
+
+std::string Category::to_string() const {
+  return fmt::format("{}({})", class_name_, name_);
+}
+
+}
@@ -21,8 +21,9 @@
 #include "iCDump/ObjC/Protocol.hpp"
 #include "iCDump/ObjC/Property.hpp"
 #include "iCDump/ObjC/IVar.hpp"
-#include <LIEF/BinaryStream/BinaryStream.hpp>
-#include <LIEF/MachO/Binary.hpp>
+#include "MachOImage.hpp"
+#include "iCDump/Arena.hpp"
+#include "MachOReader.hpp"
 
 #include "ClangAST/utils.hpp"
 
@@ -34,33 +35,16 @@ namespace iCDump::ObjC {
 
 Class::Class() = default;
 
-std::unique_ptr<Class> Class::create(Parser& parser) {
-  LIEF::BinaryStream& stream = parser.stream();
-  const size_t P = stream.pos();
-  auto cls_obj = stream.peek<ObjC::objc_class_t>();
-  if (!cls_obj) {
-    ICDUMP_ERR("Can't read objc_class_t at 0x{:x}", P);
-    return nullptr;
-  }
-
-  // We assume that the classes metadata are class_ro_t
-  uintptr_t cls_ro_ptr = parser.decode_ptr(cls_obj->bits.class_ro_ptr());
-  auto raw_ro_cls = stream.peek<ObjC::class_ro_t>(cls_ro_ptr);
-  if (!raw_ro_cls) {
-    if (parser.bin().memory_base_address() > 0) {
-      raw_ro_cls = stream.peek<ObjC::class_ro_t>(cls_obj->bits.class_ro_ptr2());
-    }
-  }
-
+Class* Class::create(Parser& parser, uintptr_t address) {
+  const MachOReader& reader = parser.reader();
+  const auto raw_ro_cls = parser.read_class_ro(address);
   if (!raw_ro_cls) {
-    ICDUMP_ERR("Can't read class_ro_t at 0x{:x}", cls_obj->bits.class_ro_ptr());
-    //ICDUMP_DEBUG("ro(): 0x{:010x}", cls_obj->bits.class_ro_ptr2());
     return nullptr;
   }
 
-  std::string name;
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_ro_cls->name))) {
-    name = std::move(*res);
+  std::string_view name;
+  if (auto res = parser.string_at(parser.decode_ptr(raw_ro_cls->name))) {
+    name = *res;
   } else {
     ICDUMP_ERR("Can't read class_ro_t.name at 0x{:x}", raw_ro_cls->name);
     return nullptr;
@@ -68,7 +52,7 @@ std::unique_ptr<Class> Class::create(Parser& parser) {
 
   ICDUMP_DEBUG("Processing class {}", name);
 
-  auto cls = std::make_unique<Class>();
+  auto cls = parser.arena().make<Class>();
 
   cls->name_           = name;
   cls->flags_          = raw_ro_cls->flags;
@@ -77,75 +61,28 @@ std::unique_ptr<Class> Class::create(Parser& parser) {
   cls->reserved_       = raw_ro_cls->reserved;
   // TODO(romain): Process the other fields (like weakIvarLayout)
 
-  if (cls_obj->super_class && parser.decode_ptr(cls_obj->super_class) != stream.pos()) {
-    const uintptr_t super_cls_ptr = parser.decode_ptr(cls_obj->super_class);
-    ICDUMP_DEBUG("Parsing super class at 0x{:010x}", super_cls_ptr);
-    LIEF::ScopedStream scoped_stream(stream, super_cls_ptr);
-    if (std::unique_ptr<Class> super_cls = create(parser)) {
-      for (auto&& m : super_cls->methods_) {
-        m->is_instance_ = false;
-        cls->methods_.push_back(std::move(m));
-      }
-    }
-  }
-
   const bool is_meta = cls->is_meta();
 
   if (raw_ro_cls->base_method_list) {
     ICDUMP_DEBUG("  Class.base_method_list");
-    LIEF::ScopedStream scoped_stream(stream, parser.decode_ptr(raw_ro_cls->base_method_list));
-    if (const auto method_list = stream.read<ObjC::method_list_t>()) {
-      const bool is_small = method_list->flags() & ObjC::method_list_t::IS_SMALL;
-      const size_t methods_addr = stream.pos();
-      const size_t sizeof_meth = is_small ? sizeof(ObjC::small_method_t) :
-                                            sizeof(ObjC::big_method_t);
-
-      for (size_t i = 0; i < method_list->count; ++i) {
-        stream.setpos(methods_addr + i * sizeof_meth);
-        ICDUMP_DEBUG("base_method_list[{}]@0x{:010x}", i, stream.pos());
-        if (std::unique_ptr<Method> method = Method::create(parser, is_small)) {
-          method->is_instance_ = !is_meta;
-          cls->methods_.push_back(std::move(method));
-        } else {
-          ICDUMP_ERR("Error while processing base methods #{:d}", i);
-          break;
-        }
-      }
-    } else {
-      ICDUMP_WARN("Can't read method_list_t@0x{:010x}", stream.pos());
-    }
+    const std::vector<Method*> methods =
+      parser.read_methods(parser.decode_ptr(raw_ro_cls->base_method_list), !is_meta);
+    cls->methods_ = parser.arena().copy(methods);
   }
 
   if (raw_ro_cls->base_protocols) {
     ICDUMP_DEBUG("  Class.base_protocols");
-    LIEF::ScopedStream scoped_stream(stream, parser.decode_ptr(raw_ro_cls->base_protocols));
-    if (const auto list = stream.read<ObjC::protocol_list_t>()) {
-      for (size_t i = 0; i < list->count; ++i) {
-        uintptr_t proto_addr = 0;
-        if (auto res = stream.read<uintptr_t>()) {
-          proto_addr = parser.decode_ptr(*res);
-        } else {
-          break;
-        }
-
-        if (Protocol* proto = parser.get_or_create_protocol(proto_addr)) {
-          cls->protocols_.push_back(proto);
-        } else {
-          ICDUMP_ERR("Error while processing protocol #{:d}", i);
-        }
-      }
-    }
+    cls->protocols_ = parser.get_or_create_protocols(parser.decode_ptr(raw_ro_cls->base_protocols));
   }
 
   if (raw_ro_cls->ivars) {
     ICDUMP_DEBUG("  Class.ivars");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_ro_cls->ivars));
-    if (const auto list = stream.read<ObjC::ivars_list_t>()) {
-      const size_t addr = stream.pos();
+    const uintptr_t list_addr = parser.decode_ptr(raw_ro_cls->ivars);
+    if (const auto list = reader.read<ObjC::ivars_list_t>(list_addr)) {
+      const uintptr_t addr = list_addr + sizeof(ObjC::ivars_list_t);
       for (size_t i = 0; i < list->count; ++i) {
-        stream.setpos(addr + i * sizeof(ObjC::ivar_t));
-        if (std::unique_ptr<IVar> ivar = IVar::create(parser)) {
-          cls->ivars_.push_back(std::move(ivar));
+        if (IVar* ivar = IVar::create(parser, addr + i * sizeof(ObjC::ivar_t))) {
+          cls->ivars_.push_back(ivar);
         }
       }
     }
@@ -153,16 +90,7 @@ std::unique_ptr<Class> Class::create(Parser& parser) {
 
   if (raw_ro_cls->base_properties) {
     ICDUMP_DEBUG("  Class.base_properties");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_ro_cls->base_properties));
-    if (const auto prop_list = stream.read<ObjC::properties_list_t>()) {
-      const size_t props_addr = stream.pos();
-      for (size_t i = 0; i < prop_list->count; ++i) {
-        stream.setpos(props_addr + i * sizeof(ObjC::property_t));
-        if (std::unique_ptr<Property> prop = Property::create(parser)) {
-          cls->properties_.push_back(std::move(prop));
-        }
-      }
-    }
+    cls->properties_ = parser.read_properties(parser.decode_ptr(raw_ro_cls->base_properties));
   }
 
   return cls;
@@ -185,7 +113,7 @@ std::string Class::demangled_name() const {
 #ifdef ICDUMP_LLVM_SUPPORT
     return swift::Demangle::demangleSymbolAsString(name_);
 #else
-    return name_;
+    return std::string(name_);
 #endif
 }
 
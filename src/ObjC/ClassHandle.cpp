@@ -12,29 +12,25 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "iCDump/ObjC/ClassHandle.hpp"
+#include "iCDump/ObjC/Parser.hpp"
 
-#ifndef ICDUMP_MACHO_STREAM_H_
-#define ICDUMP_MACHO_STREAM_H_
-#include <LIEF/BinaryStream/BinaryStream.hpp>
+namespace iCDump::ObjC {
 
-namespace LIEF::MachO {
-class Binary;
+bool ClassHandle::is_resolved() const {
+  return parser_ == nullptr || resolved_.load(std::memory_order_acquire);
 }
 
-namespace iCDump {
-class MachOStream : public LIEF::BinaryStream {
-  public:
-  MachOStream(const LIEF::MachO::Binary& bin);
-  uint64_t size() const override;
-
-  LIEF::result<const void*> read_at(uint64_t offset, uint64_t size) const override;
-
-  inline const LIEF::MachO::Binary& bin() const {
-    return *binary_;
+const Class* ClassHandle::get() const {
+  if (parser_ == nullptr) {
+    return cls_;
   }
 
-  private:
-  const LIEF::MachO::Binary* binary_ = nullptr;
-};
+  std::call_once(once_, [this] {
+    cls_ = parser_->resolve_class(address_);
+    resolved_.store(true, std::memory_order_release);
+  });
+  return cls_;
+}
+
 }
-#endif
@@ -14,31 +14,34 @@
  */
 #include "iCDump/ObjC/IVar.hpp"
 #include "iCDump/ObjC/Parser.hpp"
+#include "iCDump/ObjC/TypeCache.hpp"
 #include "iCDump/ObjC/Types.hpp"
 #include "iCDump/ObjC/TypesEncoding.hpp"
 #include "log.hpp"
 
-#include <LIEF/BinaryStream/BinaryStream.hpp>
+#include "iCDump/Arena.hpp"
+#include "MachOReader.hpp"
 
 namespace iCDump::ObjC {
 
-std::unique_ptr<IVar> IVar::create(Parser& parser) {
-  LIEF::BinaryStream& stream = parser.stream();
-  const auto raw_ivar = stream.peek<ObjC::ivar_t>();
+IVar* IVar::create(const Parser& parser, uintptr_t address) {
+  const MachOReader& reader = parser.reader();
+  const auto raw_ivar = reader.read<ObjC::ivar_t>(address);
 
   if (!raw_ivar) {
     return nullptr;
   }
 
-  auto ivar = std::make_unique<IVar>();
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_ivar->name))) {
-    ivar->name_ = std::move(*res);
+  auto ivar = parser.arena().make<IVar>();
+  ivar->type_cache_ = &parser.type_cache();
+  if (auto res = parser.string_at(parser.decode_ptr(raw_ivar->name))) {
+    ivar->name_ = *res;
   } else {
     ICDUMP_ERR("Can't read ivar.name at 0x{:x}", parser.decode_ptr(raw_ivar->name));
   }
 
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_ivar->type))) {
-    ivar->mangled_type_ = std::move(*res);
+  if (auto res = parser.string_at(parser.decode_ptr(raw_ivar->type))) {
+    ivar->mangled_type_ = *res;
   } else {
     ICDUMP_ERR("Can't read ivar.type at 0x{:x}", parser.decode_ptr(raw_ivar->type));
   }
@@ -47,16 +50,16 @@ std::unique_ptr<IVar> IVar::create(Parser& parser) {
 }
 
 
-std::unique_ptr<Type> IVar::type() const {
-  if (mangled_type_.empty()) {
+const Type* IVar::type() const {
+  if (mangled_type_.empty() || type_cache_ == nullptr) {
     return nullptr;
   }
-  std::vector<std::unique_ptr<Type>> types = decode_type(mangled_type());
+  TypeCache::types_t types = type_cache_->decode(mangled_type_);
   if (types.size() != 1) {
     ICDUMP_ERR("Error while parsing type: {}", mangled_type());
     return nullptr;
   }
-  return std::move(types.back());
+  return types[0];
 }
 
 
@@ -0,0 +1,124 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <numeric>
+
+#include "iCDump/ObjC/ImpIndex.hpp"
+#include "iCDump/ObjC/Category.hpp"
+#include "iCDump/ObjC/Class.hpp"
+#include "iCDump/ObjC/Method.hpp"
+#include "log.hpp"
+
+namespace iCDump::ObjC {
+
+void ImpIndex::finalize(const std::vector<uint64_t>& function_starts, uint64_t limit) {
+  std::vector<uint32_t> order(starts_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this] (uint32_t lhs, uint32_t rhs) {
+                     return starts_[lhs] < starts_[rhs];
+                   });
+
+  std::vector<uint64_t> starts;
+  std::vector<const Method*> methods;
+  std::vector<const Class*> classes;
+  std::vector<const Category*> categories;
+  starts.reserve(order.size());
+  methods.reserve(order.size());
+  classes.reserve(order.size());
+  categories.reserve(order.size());
+  for (uint32_t idx : order) {
+    // Methods sharing the same implementation: the first one is kept
+    if (!starts.empty() && starts.back() == starts_[idx]) {
+      continue;
+    }
+    starts.push_back(starts_[idx]);
+    methods.push_back(methods_[idx]);
+    classes.push_back(classes_[idx]);
+    categories.push_back(categories_[idx]);
+  }
+  starts_  = std::move(starts);
+  methods_ = std::move(methods);
+  classes_ = std::move(classes);
+  categories_ = std::move(categories);
+
+  ends_.resize(starts_.size());
+  for (size_t i = 0; i < starts_.size(); ++i) {
+    uint64_t end = i + 1 < starts_.size() ? starts_[i + 1] : std::max(limit, starts_[i]);
+    auto it = std::upper_bound(function_starts.begin(), function_starts.end(), starts_[i]);
+    if (it != function_starts.end() && *it < end) {
+      end = *it;
+    }
+    ends_[i] = end;
+  }
+}
+
+uint32_t ImpIndex::lookup(uint64_t address) const {
+  const uint64_t* base = starts_.data();
+  size_t size = starts_.size();
+  if (size == 0 || address < base[0]) {
+    return NOT_FOUND;
+  }
+
+  // Branchless search of the last start <= address
+  while (size > 1) {
+    const size_t half = size / 2;
+    base = base[half] <= address ? base + half : base;
+    size -= half;
+  }
+  const auto idx = static_cast<uint32_t>(base - starts_.data());
+  return address < ends_[idx] ? idx : NOT_FOUND;
+}
+
+void ImpIndex::lookup(span<const uint64_t> addresses, span<uint32_t> out) const {
+  if (addresses.size() != out.size()) {
+    ICDUMP_ERR("The output doesn't match the number of addresses");
+    return;
+  }
+
+  if (!std::is_sorted(addresses.begin(), addresses.end())) {
+    for (size_t i = 0; i < addresses.size(); ++i) {
+      out[i] = lookup(addresses[i]);
+    }
+    return;
+  }
+
+  size_t idx = 0;
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    const uint64_t address = addresses[i];
+    while (idx + 1 < starts_.size() && starts_[idx + 1] <= address) {
+      ++idx;
+    }
+    const bool found = idx < starts_.size() && starts_[idx] <= address && address < ends_[idx];
+    out[i] = found ? static_cast<uint32_t>(idx) : NOT_FOUND;
+  }
+}
+
+std::vector<uint32_t> ImpIndex::lookup(span<const uint64_t> addresses) const {
+  std::vector<uint32_t> out(addresses.size(), NOT_FOUND);
+  lookup(addresses, out);
+  return out;
+}
+
+std::string ImpIndex::symbol(uint32_t idx) const {
+  const Method& meth = *methods_[idx];
+  const char prefix = meth.is_instance() ? '-' : '+';
+  if (const Category* cat = categories_[idx]) {
+    return fmt::format("{}[{}({}) {}]", prefix, cat->class_name(), cat->name(), meth.name());
+  }
+  return fmt::format("{}[{} {}]", prefix, classes_[idx]->name(), meth.name());
+}
+
+}
@@ -14,13 +14,30 @@
  */
 #include "iCDump/ObjC/Metadata.hpp"
 #include "iCDump/ObjC/Class.hpp"
+#include "iCDump/ObjC/ClassHandle.hpp"
+#include "iCDump/ObjC/Parser.hpp"
 #include "iCDump/ObjC/Protocol.hpp"
 
+#include "iCDump/Arena.hpp"
+
 namespace iCDump::ObjC {
+Metadata::Metadata() = default;
+Metadata::~Metadata() = default;
+
 const Class* Metadata::get_class(const std::string& name) const {
   if (auto it = classes_lookup_.find(name); it != std::end(classes_lookup_)) {
     return it->second;
   }
+  if (const ClassHandle* handle = get_class_handle(name)) {
+    return handle->get();
+  }
+  return nullptr;
+}
+
+const ClassHandle* Metadata::get_class_handle(const std::string& name) const {
+  if (auto it = class_handles_lookup_.find(name); it != std::end(class_handles_lookup_)) {
+    return it->second;
+  }
   return nullptr;
 }
 
@@ -39,8 +56,11 @@ std::string Metadata::to_decl() const {
     out += protocol->to_decl();
   }
 
-  for (const auto& cls : classes_) {
-    out += cls->to_decl();
+  // The classes of a lazy Metadata are decoded here
+  for (const ClassHandle* handle : class_handles_) {
+    if (const Class* cls = handle->get()) {
+      out += cls->to_decl();
+    }
   }
 
   return out;
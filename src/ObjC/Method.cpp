@@ -15,81 +15,84 @@
 #include "iCDump/ObjC/Method.hpp"
 #include "iCDump/ObjC/Types.hpp"
 #include "iCDump/ObjC/Parser.hpp"
+#include "iCDump/ObjC/TypeCache.hpp"
 #include "iCDump/ObjC/TypesEncoding.hpp"
 #include "log.hpp"
 
-#include <LIEF/BinaryStream/BinaryStream.hpp>
+#include "iCDump/Arena.hpp"
+#include "MachOReader.hpp"
 
 namespace iCDump::ObjC {
-std::unique_ptr<Method> Method::create(Parser& parser, bool is_small) {
-  LIEF::BinaryStream& stream = parser.stream();
-  ICDUMP_DEBUG("Parsing ObjC Method @0x{:x}", stream.pos());
-  auto method = std::make_unique<Method>();
+Method* Method::create(const Parser& parser, uintptr_t address, bool is_small) {
+  const MachOReader& reader = parser.reader();
+  ICDUMP_DEBUG("Parsing ObjC Method @0x{:x}", address);
+  auto method = parser.arena().make<Method>();
+  method->type_cache_ = &parser.type_cache();
   if (is_small) {
-    ICDUMP_DEBUG("meth@0x{:x}: is small", stream.pos());
-    const size_t pos = stream.pos();
-    const auto raw_method = stream.peek<ObjC::small_method_t>();
+    ICDUMP_DEBUG("meth@0x{:x}: is small", address);
+    const auto raw_method = reader.read<ObjC::small_method_t>(address);
     if (!raw_method) {
-      ICDUMP_WARN("meth@0x{:x}: can't read small_method_t", stream.pos());
+      ICDUMP_WARN("meth@0x{:x}: can't read small_method_t", address);
       return nullptr;
     }
 
-    if (auto str_ptr = stream.peek<uintptr_t>(pos + raw_method->name)) {
+    if (auto str_ptr = reader.read<uintptr_t>(address + raw_method->name)) {
       const uintptr_t decoded = parser.decode_ptr(*str_ptr);
-      if (auto res = stream.peek_string_at(decoded)) {
-        method->name_ = std::move(*res);
+      if (auto res = parser.string_at(decoded)) {
+        method->name_ = *res;
       } else {
-        ICDUMP_WARN("meth@0x{:x}: can't read name", stream.pos());
+        ICDUMP_WARN("meth@0x{:x}: can't read name", address);
       }
     } else {
-      ICDUMP_WARN("Can't read small method name ptr (0x{:010x})", pos + raw_method->name);
+      ICDUMP_WARN("Can't read small method name ptr (0x{:010x})", address + raw_method->name);
     }
 
-    if (auto res = stream.peek_string_at(pos + offsetof(ObjC::small_method_t, types) + raw_method->types)) {
-      method->mangled_type_ = std::move(*res);
+    if (auto res = parser.string_at(address + offsetof(ObjC::small_method_t, types) + raw_method->types)) {
+      method->mangled_type_ = *res;
+    }
+    // Like the name and the types, the imp is relative to the field's address
+    if (raw_method->imp != 0) {
+      method->addr_ = address + offsetof(ObjC::small_method_t, imp) + raw_method->imp;
     }
-    method->addr_ = raw_method->imp;
     return method;
   }
 
-  ICDUMP_DEBUG("meth@0x{:x}: is not small", stream.pos());
-  auto raw_method = stream.peek<ObjC::big_method_t>();
+  ICDUMP_DEBUG("meth@0x{:x}: is not small", address);
+  auto raw_method = reader.read<ObjC::big_method_t>(address);
   if (!raw_method) {
-    ICDUMP_WARN("meth@0x{:x}: can't read big_method_t", stream.pos());
+    ICDUMP_WARN("meth@0x{:x}: can't read big_method_t", address);
     return nullptr;
   }
 
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_method->name))) {
-    method->name_ = std::move(*res);
+  if (auto res = parser.string_at(parser.decode_ptr(raw_method->name))) {
+    method->name_ = *res;
   }
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_method->types))) {
-    method->mangled_type_ = std::move(*res);
+  if (auto res = parser.string_at(parser.decode_ptr(raw_method->types))) {
+    method->mangled_type_ = *res;
   }
 
-  method->addr_ = raw_method->imp;
+  if (raw_method->imp != 0) {
+    method->addr_ = parser.decode_ptr(raw_method->imp);
+  }
 
   return method;
 
 }
 
-Method::prototype_t Method::prototype() const {
-  types_t types = decode_type(mangled_type());
-
-  if (types.empty()) {
-    ICDUMP_ERR("Decoding {} failed", mangled_type());
-    return {};
-  }
-  // First extract the return type
-  auto it = std::begin(types);
-  std::unique_ptr<Type> ret = std::move(*it++);
-
-  // Then the parameter types
-  types_t params;
-  for (; it != std::end(types); ++it) {
-    params.push_back(std::move(*it));
-  }
-  types.clear();
-  return {std::move(ret), std::move(params)};
+const Method::prototype_t& Method::prototype() const {
+  std::call_once(prototype_once_, [this] {
+    if (type_cache_ == nullptr) {
+      ICDUMP_ERR("{}: no type cache", name());
+      return;
+    }
+    TypeCache::types_t types = type_cache_->decode(mangled_type_);
+    if (types.empty()) {
+      return;
+    }
+    // The first type is the return type, followed by the parameter types
+    prototype_ = {types[0], {types.data() + 1, types.size() - 1}};
+  });
+  return prototype_;
 }
 
 
@@ -0,0 +1,59 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "iCDump/ObjC/MethodStore.hpp"
+#include "iCDump/ObjC/Method.hpp"
+
+namespace iCDump::ObjC {
+
+MethodStore::id_t MethodStore::find(std::string_view str) const {
+  if (auto it = lookup_.find(str); it != std::end(lookup_)) {
+    return it->second;
+  }
+  return NO_ID;
+}
+
+MethodStore::id_t MethodStore::intern(std::string_view str) {
+  const auto [it, inserted] = lookup_.try_emplace(str, static_cast<id_t>(strings_.size()));
+  if (inserted) {
+    strings_.push_back(str);
+  }
+  return it->second;
+}
+
+void MethodStore::reserve(size_t size) {
+  selectors_.reserve(size);
+  types_.reserve(size);
+  imps_.reserve(size);
+  owners_.reserve(size);
+  flags_.reserve(size);
+  methods_.reserve(size);
+}
+
+span<Method* const> MethodStore::append(span<Method* const> methods, uint32_t owner,
+                                        uint8_t flags)
+{
+  const size_t start = methods_.size();
+  for (Method* meth : methods) {
+    selectors_.push_back(intern(meth->name()));
+    types_.push_back(intern(meth->mangled_type()));
+    imps_.push_back(meth->address());
+    owners_.push_back(owner);
+    flags_.push_back(meth->is_instance() ? flags | INSTANCE : flags);
+    methods_.push_back(meth);
+  }
+  return {methods_.data() + start, methods.size()};
+}
+
+}
@@ -12,26 +12,42 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <unordered_set>
+
 #include "iCDump/ObjC/Parser.hpp"
 #include "iCDump/ObjC/Metadata.hpp"
+#include "iCDump/ObjC/Category.hpp"
 #include "iCDump/ObjC/Class.hpp"
+#include "iCDump/ObjC/ClassHandle.hpp"
 #include "iCDump/ObjC/Method.hpp"
 #include "iCDump/ObjC/Protocol.hpp"
 #include "iCDump/ObjC/Property.hpp"
 #include "iCDump/ObjC/IVar.hpp"
-#include "MachOStream.hpp"
+#include "iCDump/ObjC/ImpIndex.hpp"
+#include "iCDump/Arena.hpp"
+#include "ChainedFixups.hpp"
+#include "MachOReader.hpp"
+#include "MachOImage.hpp"
+#include "StringPool.hpp"
+#include "ThreadPool.hpp"
 #include "iCDump/ObjC/Types.hpp"
 #include "log.hpp"
 
-#include "LIEF/MachO.hpp"
-#include "LIEF/BinaryStream/SpanStream.hpp"
-
-using namespace LIEF::MachO;
-
 namespace iCDump::ObjC {
+using section_t = MachOImage::section_t;
+
+//! Minimal number of entries processed by a task
+static constexpr size_t MIN_CHUNK_SIZE = 64;
 
+//! Identifier of the Parser instances. It is used (instead of the address)
+//! to bind the thread-local arena to its parser
+static std::atomic<uint64_t> PARSER_ID{0};
 
-const Section* get_objc_section(const Binary& bin, const std::string& name) {
+const section_t* get_objc_section(const MachOImage& bin, const std::string& name) {
   if (const auto* sec = bin.get_section("__DATA", name)) {
     return sec;
   }
@@ -47,129 +63,839 @@ const Section* get_objc_section(const Binary& bin, const std::string& name) {
   return nullptr;
 }
 
-inline const Section* get_objc_classlist(const Binary& bin) {
+inline const section_t* get_objc_classlist(const MachOImage& bin) {
   return get_objc_section(bin, "__objc_classlist");
 }
 
-inline const Section* get_objc_protolist(const Binary& bin) {
+inline const section_t* get_objc_protolist(const MachOImage& bin) {
   return get_objc_section(bin, "__objc_protolist");
 }
 
-Parser::Parser() = default;
+//! Prefixes of the symbols bound to the class_t of another image
+static constexpr std::string_view OBJC_CLASS_PREFIX     = "_OBJC_CLASS_$_";
+static constexpr std::string_view OBJC_METACLASS_PREFIX = "_OBJC_METACLASS_$_";
+
+//! Location of objc_class_t's fields
+static constexpr uintptr_t ISA_OFFSET         = 0;
+static constexpr uintptr_t SUPER_CLASS_OFFSET = sizeof(objc_object_t);
+
+//! Index the C-string sections referenced by the ObjC structures
+std::unique_ptr<StringPool> index_strings(const MachOImage& bin) {
+  static constexpr const char* SECTIONS[] = {
+    "__objc_methname", "__objc_classname", "__objc_methtype", "__cstring",
+  };
+  auto pool = std::make_unique<StringPool>();
+  for (const char* name : SECTIONS) {
+    if (const section_t* sec = bin.get_section("__TEXT", name)) {
+      pool->add(sec->virtual_address, sec->content);
+    }
+  }
+  ICDUMP_DEBUG("Nb unique strings: {}", pool->size());
+  return pool;
+}
+
+//! Call ``func(i)`` for i in [0, count). The range is split into chunks
+//! which are processed by ``nb_threads`` threads
+template<class F>
+void for_each_chunk(size_t count, size_t nb_threads, const F& func) {
+  if (nb_threads <= 1 || count < 2 * MIN_CHUNK_SIZE) {
+    for (size_t i = 0; i < count; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  const size_t chunk_size = std::max(MIN_CHUNK_SIZE, count / (4 * nb_threads) + 1);
+  const size_t nb_chunks  = (count + chunk_size - 1) / chunk_size;
+  ThreadPool pool(std::min(nb_threads, nb_chunks));
+  for (size_t start = 0; start < count; start += chunk_size) {
+    const size_t end = std::min(count, start + chunk_size);
+    pool.enqueue([&func, start, end] {
+      for (size_t i = start; i < end; ++i) {
+        func(i);
+      }
+    });
+  }
+  pool.wait();
+}
 
-Parser::Parser(const Binary* bin) :
-  bin_{bin},
-  stream_{std::make_unique<MachOStream>(*bin)},
+Parser::Parser(const MachOImage* image, size_t nb_threads, bool copy_strings) :
+  image_{image},
+  imagebase_{image->imagebase()},
+  // The pointers of an image loaded in memory are already fixed up
+  fixups_{image->memory_base_address() == 0 ? image->chained_fixups() : nullptr},
+  nb_threads_{nb_threads > 0 ? nb_threads : ThreadPool::default_concurrency()},
+  copy_strings_{copy_strings},
+  id_{++PARSER_ID},
+  reader_{std::make_unique<MachOReader>(*image)},
+  strings_{index_strings(*image)},
   metadata_{std::make_unique<Metadata>()},
-  imagebase_{bin_->imagebase()}
+  type_cache_{&metadata_->type_cache_}
 {
+  for (const MachOImage::binding_t& binding : image->bindings()) {
+    bindings_.emplace(binding.address, binding.symbol);
+  }
+}
+
+Parser::~Parser() = default;
+
+std::unique_ptr<Metadata> Parser::parse(const LIEF::MachO::Binary& bin, size_t nb_threads) {
+  std::unique_ptr<MachOImage> image = MachOImage::from_binary(bin);
+  return parse(*image, nb_threads, nullptr, /* copy_strings */true);
 }
 
-std::unique_ptr<Metadata> Parser::parse(const Binary& bin) {
-  Parser parser(&bin);
+std::unique_ptr<Metadata> Parser::parse(const MachOImage& image, size_t nb_threads,
+                                        storage_t storage)
+{
+  return parse(image, nb_threads, std::move(storage), /* copy_strings */false);
+}
+
+std::unique_ptr<Metadata> Parser::parse(const MachOImage& image, size_t nb_threads,
+                                        storage_t storage, bool copy_strings)
+{
+  Parser parser(&image, nb_threads, copy_strings);
 
   parser
     .process_protocols()
-    .process_classes();
+    .process_classes()
+    .process_categories()
+    .process_class_refs()
+    .build_indexes();
 
+  parser.metadata_->storage_ = std::move(storage);
+  parser.metadata_->arenas_  = std::move(parser.arenas_);
   return std::move(parser.metadata_);
 }
 
+std::unique_ptr<Metadata> Parser::parse_lazy(std::unique_ptr<MachOImage> image, size_t nb_threads,
+                                             storage_t storage)
+{
+  std::unique_ptr<Parser> parser(new Parser(image.get(), nb_threads, /* copy_strings */false));
+  parser->owned_image_ = std::move(image);
+
+  // The protocols (including the ones only referenced by the classes and
+  // the categories) are decoded eagerly so that Metadata::protocols() is
+  // complete and no longer modified once parsed
+  parser->process_protocols()
+         .process_class_handles()
+         .index_categories();
+
+  std::unique_ptr<Metadata> metadata = std::move(parser->metadata_);
+  metadata->storage_ = std::move(storage);
+  metadata->arenas_  = std::move(parser->arenas_);
+  metadata->parser_  = std::move(parser);
+  return metadata;
+}
 
-Protocol* Parser::get_or_create_protocol(uintptr_t offset) {
-  if (auto it = protocols_.find(offset); it != std::end(protocols_)) {
+Arena& Parser::arena() const {
+  // Fast path: the parser last used by this thread
+  thread_local uint64_t parser_id = 0;
+  thread_local Arena* arena = nullptr;
+  if (parser_id == id_) {
+    return *arena;
+  }
+
+  std::lock_guard lock(arenas_mutex_);
+  Arena*& owned = thread_arenas_[std::this_thread::get_id()];
+  if (owned == nullptr) {
+    owned = arenas_.emplace_back(std::make_unique<Arena>()).get();
+  }
+  arena = owned;
+  parser_id = id_;
+  return *arena;
+}
+
+std::string_view Parser::make_string(std::string_view str) const {
+  return copy_strings_ ? arena().copy(str) : str;
+}
+
+LIEF::result<std::string_view> Parser::string_at(uintptr_t address) const {
+  if (const StringPool::id_t id = strings_->find(reader().translate(address));
+      id != StringPool::NO_ID)
+  {
+    return make_string(strings_->get(id));
+  }
+
+  if (auto res = reader().cstring_at(address)) {
+    return make_string(*res);
+  }
+  return make_error_code(lief_errors::read_error);
+}
+
+Protocol* Parser::register_protocol(uintptr_t address, Protocol* proto) {
+  protocols_[address] = proto;
+  if (proto == nullptr) {
+    return nullptr;
+  }
+  metadata_->protocol_lookup_[proto->mangled_name()] = proto;
+  metadata_->protocols_.push_back(proto);
+  return proto;
+}
+
+void Parser::link_protocol(uintptr_t address, Protocol& proto) {
+  if (const auto raw_proto = reader().read<protocol_t>(address); raw_proto && raw_proto->protocols) {
+    proto.protocols_ = get_or_create_protocols(decode_ptr(raw_proto->protocols));
+  }
+}
+
+void Parser::flush_protocols() {
+  std::lock_guard lock(protocols_mutex_);
+  for (const auto& [address, proto] : pending_protocols_) {
+    metadata_->protocol_lookup_[proto->mangled_name()] = proto;
+    metadata_->protocols_.push_back(proto);
+  }
+  pending_protocols_.clear();
+}
+
+Protocol* Parser::get_or_create_protocol(uintptr_t address) {
+  std::lock_guard lock(protocols_mutex_);
+  if (auto it = protocols_.find(address); it != std::end(protocols_)) {
     return it->second;
   }
 
+  // Failures are also cached so that they are not processed again
+  Protocol* proto = Protocol::create(*this, address);
+  protocols_[address] = proto;
+  if (proto == nullptr) {
+    ICDUMP_ERR("Error while parsing protocol at 0x{:x}", address);
+    return nullptr;
+  }
+
+  // The protocols of a lazy Metadata are complete once parsed
+  // (see process_class_handles() and index_categories())
+  if (metadata_ != nullptr) {
+    pending_protocols_[address] = proto;
+  }
 
-  LIEF::BinaryStream& mstream = stream();
-  LIEF::ScopedStream scoped(mstream, offset);
+  // Resolved once cached so that a cycle resolves to this object
+  link_protocol(address, *proto);
+  return proto;
+}
 
-  std::unique_ptr<Protocol> proto = Protocol::create(*this);
-  if (!proto) {
-    ICDUMP_ERR("Error while parsing protocol at offset 0x{:x}", offset);
+std::vector<Protocol*> Parser::get_or_create_protocols(uintptr_t address) {
+  const auto list = reader().read<protocol_list_t>(address);
+  if (!list) {
+    ICDUMP_WARN("Can't read protocol_list_t@0x{:010x}", address);
+    return {};
+  }
+
+  std::vector<Protocol*> protocols;
+  const uintptr_t refs = address + sizeof(protocol_list_t);
+  for (size_t i = 0; i < list->count; ++i) {
+    const auto ref = reader().read<protocol_ref_t>(refs + i * sizeof(protocol_ref_t));
+    if (!ref) {
+      break;
+    }
+
+    if (Protocol* proto = get_or_create_protocol(decode_ptr(*ref))) {
+      protocols.push_back(proto);
+    } else {
+      ICDUMP_ERR("Error while processing protocol #{:d}", i);
+    }
+  }
+  return protocols;
+}
+
+Class* Parser::register_class(uintptr_t address, Class* cls) {
+  classes_[address] = cls;
+  return cls;
+}
+
+void Parser::link_class(uintptr_t address, Class& cls) {
+  const auto raw_cls = reader().read<objc_class_t>(address);
+  if (!raw_cls) {
+    return;
+  }
+
+  // The pointers bound to another image (e.g. NSObject) can't be read
+  if (raw_cls->isa && bound_symbol(address + ISA_OFFSET).empty()) {
+    cls.meta_ = get_or_create_class(decode_ptr(raw_cls->isa));
+  }
+
+  if (std::string_view name = bound_class(address + SUPER_CLASS_OFFSET); !name.empty()) {
+    cls.super_name_ = name;
+  } else if (raw_cls->super_class) {
+    cls.super_ = get_or_create_class(decode_ptr(raw_cls->super_class));
+  }
+}
+
+Class* Parser::get_or_create_class(uintptr_t address) {
+  if (auto it = classes_.find(address); it != std::end(classes_)) {
+    return it->second;
+  }
+
+  // e.g. classes imported from another library
+  if (image_->segment_from_virtual_address(address) == nullptr) {
+    ICDUMP_DEBUG("0x{:010x} is outside of the image", address);
     return nullptr;
   }
-  auto* raw_ptr = proto.get();
-  metadata_->protocol_lookup_[proto->mangled_name()] = proto.get();
-  metadata_->protocols_.push_back(std::move(proto));
 
-  return raw_ptr;
+  // Failures are also cached so that they are not processed again
+  Class* cls = register_class(address, Class::create(*this, address));
+  if (cls == nullptr) {
+    return nullptr;
+  }
+
+  // The links are resolved once the class is cached such as the
+  // cycles (e.g. the root metaclass' isa) resolve to this object
+  link_class(address, *cls);
+  attach_lazy_categories(address, *cls);
+  return cls;
+}
+
+//! Decoded pointers of a __objc_*list section. With chained fixups,
+//! the slots which are not fixups are decoded as 0.
+std::vector<uintptr_t> read_pointers(const Parser& parser, const section_t& section) {
+  const ChainedFixups* fixups = parser.chained_fixups();
+  const size_t nb_ptrs = section.content.size() / sizeof(uintptr_t);
+  std::vector<uintptr_t> pointers;
+  pointers.reserve(nb_ptrs);
+  for (size_t i = 0; i < nb_ptrs; ++i) {
+    const uintptr_t address = section.virtual_address + i * sizeof(uintptr_t);
+    if (fixups != nullptr && !fixups->is_fixup(address)) {
+      ICDUMP_DEBUG("{}[{}] is not a fixup", section.name, i);
+      pointers.push_back(0);
+      continue;
+    }
+    uintptr_t value = 0;
+    std::memcpy(&value, section.content.data() + i * sizeof(uintptr_t), sizeof(uintptr_t));
+    pointers.push_back(parser.decode_ptr(value));
+  }
+  return pointers;
+}
+
+Class* Parser::resolve_class(uintptr_t address) {
+  std::lock_guard lock(classes_mutex_);
+  return get_or_create_class(address);
+}
+
+LIEF::result<class_ro_t> Parser::read_class_ro(uintptr_t address) const {
+  const auto cls_obj = reader().read<objc_class_t>(address);
+  if (!cls_obj) {
+    ICDUMP_ERR("Can't read objc_class_t at 0x{:x}", address);
+    return make_error_code(lief_errors::read_error);
+  }
+
+  // The pointer is decoded before its flags (e.g. FAST_IS_SWIFT_STABLE) are
+  // masked. For the classes of an image loaded in memory, it can
+  // point to the class_rw_t of the realized class.
+  const uintptr_t cls_ro_ptr = decode_ptr(cls_obj->bits.bits) & class_data_bits_t::FAST_DATA_MASK;
+  auto raw_ro_cls = reader().read<class_ro_t>(cls_ro_ptr);
+  if (!raw_ro_cls && image_->memory_base_address() > 0) {
+    raw_ro_cls = reader().read<class_ro_t>(cls_obj->bits.class_ro_ptr2());
+  }
+
+  if (!raw_ro_cls) {
+    ICDUMP_ERR("Can't read class_ro_t at 0x{:x}", cls_ro_ptr);
+  }
+  return raw_ro_cls;
+}
+
+void Parser::add_class_handle(uintptr_t address, std::string_view name, Class* cls) {
+  auto handle = arena().make<ClassHandle>();
+  handle->address_ = address;
+  handle->name_    = name;
+  if (cls != nullptr) {
+    handle->cls_ = cls;
+    handle->resolved_ = true;
+  } else {
+    handle->parser_ = this;
+  }
+  metadata_->class_handles_lookup_[name] = handle;
+  metadata_->class_handles_.push_back(handle);
+}
+
+Parser& Parser::process_class_handles() {
+  const section_t* sec = get_objc_classlist(*image_);
+  if (sec == nullptr) {
+    return *this;
+  }
+
+  const std::vector<uintptr_t> locations = read_pointers(*this, *sec);
+  ICDUMP_DEBUG("__objc_classlist: #{} (lazy)", locations.size());
+
+  // Only the names and the protocol lists are decoded. The metaclasses
+  // reference the same protocol_list_t as their class.
+  std::vector<std::string_view> names(locations.size());
+  std::vector<uintptr_t> protocol_lists(locations.size(), 0);
+  for_each_chunk(locations.size(), nb_threads_, [&] (size_t i) {
+    if (const auto raw_ro_cls = read_class_ro(locations[i])) {
+      if (auto res = string_at(decode_ptr(raw_ro_cls->name))) {
+        names[i] = *res;
+      }
+      if (raw_ro_cls->base_protocols) {
+        protocol_lists[i] = decode_ptr(raw_ro_cls->base_protocols);
+      }
+    }
+  });
+
+  for (size_t i = 0; i < locations.size(); ++i) {
+    if (names[i].empty()) {
+      ICDUMP_WARN("Can't read __objc_classlist@0x{:010x}", locations[i]);
+      continue;
+    }
+    add_class_handle(locations[i], names[i], nullptr);
+    if (protocol_lists[i] > 0) {
+      get_or_create_protocols(protocol_lists[i]);
+    }
+  }
+
+  // Protocols only referenced by the classes
+  flush_protocols();
+  return *this;
 }
 
 Parser& Parser::process_protocols() {
-  if (const Section* sec = get_objc_protolist(*bin_)) {
-    ICDUMP_DEBUG("ObjC Protocol from: {}: 0x{:010x}", sec->name(), sec->virtual_address());
-    LIEF::SpanStream protolist(sec->content());
-    return process_protocols(*stream_, protolist);
+  if (const section_t* sec = get_objc_protolist(*image_)) {
+    ICDUMP_DEBUG("ObjC Protocol from: {}: 0x{:010x}", sec->name, sec->virtual_address);
+    return process_protocols(read_pointers(*this, *sec));
   }
   return *this;
 }
 
-Parser& Parser::process_protocols(LIEF::BinaryStream& mstream, LIEF::BinaryStream& protolist) {
-  const size_t nb_protos = protolist.size() / sizeof(uintptr_t);
-  ICDUMP_DEBUG("Nb protocols: {:d}", nb_protos);
-  for (size_t i = 0; i < nb_protos; ++i) {
-    uintptr_t location = 0;
-    ICDUMP_DEBUG("  __objc_protolist[{}]", i);
-    if (auto res = protolist.read<uintptr_t>()) {
-      location = decode_ptr(*res);
+Parser& Parser::process_protocols(const std::vector<uintptr_t>& locations) {
+  ICDUMP_DEBUG("Nb protocols: {:d}", locations.size());
+
+  // The protocols are decoded concurrently and then registered in the
+  // order of __objc_protolist
+  std::vector<Protocol*> protocols(locations.size(), nullptr);
+  for_each_chunk(locations.size(), nb_threads_, [&] (size_t i) {
+    ICDUMP_DEBUG("  __objc_protolist[{}]@0x{:010x}", i, locations[i]);
+    protocols[i] = Protocol::create(*this, locations[i]);
+  });
+
+  std::vector<std::pair<uintptr_t, Protocol*>> listed;
+  for (size_t i = 0; i < locations.size(); ++i) {
+    if (protocols_.find(locations[i]) != std::end(protocols_)) {
+      continue;
+    }
+
+    if (Protocol* proto = register_protocol(locations[i], protocols[i])) {
+      listed.emplace_back(locations[i], proto);
     } else {
-      ICDUMP_WARN("Can't read __objc_protolist[{}]", i);
-      break;
+      ICDUMP_WARN("Can't read __objc_protolist@0x{:010x}", locations[i]);
     }
+  }
+
+  for (const auto& [address, proto] : listed) {
+    link_protocol(address, *proto);
+  }
+  flush_protocols();
+  return *this;
+}
+
+Parser& Parser::process_classes() {
+  if (const section_t* sec = get_objc_classlist(*image_)) {
+    return process_classes(read_pointers(*this, *sec));
+  }
+  return *this;
+}
+
+Parser& Parser::process_classes(const std::vector<uintptr_t>& locations) {
+  ICDUMP_DEBUG("__objc_classlist: #{}", locations.size());
+
+  struct decoded_t {
+    Class* cls = nullptr;
+    uintptr_t meta_address = 0;
+    Class* meta = nullptr;
+  };
+
+  // The classes and their metaclass are decoded concurrently. The links
+  // (isa, superclass) are then resolved sequentially, in the order of
+  // __objc_classlist, so that the result doesn't depend on the scheduling
+  std::vector<decoded_t> decoded(locations.size());
+  for_each_chunk(locations.size(), nb_threads_, [&] (size_t i) {
+    ICDUMP_DEBUG("  __objc_classlist[{}]@{:010x}", i, locations[i]);
+    if (image_->segment_from_virtual_address(locations[i]) == nullptr) {
+      return;
+    }
+    decoded_t& entry = decoded[i];
+    entry.cls = Class::create(*this, locations[i]);
+    if (entry.cls == nullptr) {
+      return;
+    }
+
+    if (const auto raw_cls = reader().read<objc_class_t>(locations[i]);
+        raw_cls && raw_cls->isa && bound_symbol(locations[i] + ISA_OFFSET).empty())
     {
-      ICDUMP_DEBUG("  __objc_protolist@0x{:010x}", location);
-      LIEF::ScopedStream scoped(mstream, location);
-      if (std::unique_ptr<Protocol> proto = Protocol::create(*this)) {
-        protocols_[location] = proto.get();
-
-        metadata_->protocol_lookup_[proto->mangled_name()] = proto.get();
-        metadata_->protocols_.push_back(std::move(proto));
-      } else {
-        ICDUMP_WARN("Can't read __objc_protolist@0x{:010x}", location);
+      const uintptr_t meta_address = decode_ptr(raw_cls->isa);
+      if (meta_address != locations[i] &&
+          image_->segment_from_virtual_address(meta_address) != nullptr)
+      {
+        entry.meta_address = meta_address;
+        entry.meta = Class::create(*this, meta_address);
+      }
+    }
+  });
+
+  std::vector<std::pair<uintptr_t, Class*>> to_link;
+  for (size_t i = 0; i < locations.size(); ++i) {
+    decoded_t& entry = decoded[i];
+    if (classes_.find(locations[i]) == std::end(classes_)) {
+      if (Class* cls = register_class(locations[i], entry.cls)) {
+        to_link.emplace_back(locations[i], cls);
+      }
+    }
+
+    if (entry.meta_address > 0 && classes_.find(entry.meta_address) == std::end(classes_)) {
+      if (Class* meta = register_class(entry.meta_address, entry.meta)) {
+        to_link.emplace_back(entry.meta_address, meta);
       }
     }
   }
+
+  for (const auto& [address, cls] : to_link) {
+    link_class(address, *cls);
+  }
+
+  for (uintptr_t location : locations) {
+    if (Class* cls = get_or_create_class(location)) {
+      metadata_->classes_lookup_[cls->name()] = cls;
+      metadata_->classes_.push_back(cls);
+      add_class_handle(location, cls->name(), cls);
+    } else {
+      ICDUMP_WARN("Can't read __objc_classlist@0x{:010x}", location);
+    }
+  }
+
+  // Protocols only referenced by the classes
+  flush_protocols();
   return *this;
 }
 
-Parser& Parser::process_classes() {
-  if (const Section* sec = get_objc_classlist(*bin_)) {
-    LIEF::SpanStream classlist(sec->content());
-    return process_classes(*stream_, classlist);
+Parser& Parser::process_categories() {
+  std::vector<uintptr_t> locations;
+  for (const char* name : {"__objc_catlist", "__objc_catlist2"}) {
+    if (const section_t* sec = get_objc_section(*image_, name)) {
+      const std::vector<uintptr_t> pointers = read_pointers(*this, *sec);
+      locations.insert(locations.end(), pointers.begin(), pointers.end());
+    }
+  }
+  if (locations.empty()) {
+    return *this;
+  }
+  return process_categories(locations);
+}
+
+Parser& Parser::process_categories(const std::vector<uintptr_t>& locations) {
+  ICDUMP_DEBUG("__objc_catlist: #{}", locations.size());
+
+  std::vector<Category*> categories(locations.size(), nullptr);
+  for_each_chunk(locations.size(), nb_threads_, [&] (size_t i) {
+    ICDUMP_DEBUG("  __objc_catlist[{}]@0x{:010x}", i, locations[i]);
+    categories[i] = Category::create(*this, locations[i]);
+  });
+
+  // The classes are resolved (and extended) in the order of the list
+  for (size_t i = 0; i < locations.size(); ++i) {
+    Category* cat = categories[i];
+    if (cat == nullptr) {
+      ICDUMP_WARN("Can't read __objc_catlist@0x{:010x}", locations[i]);
+      continue;
+    }
+    metadata_->categories_.push_back(cat);
+
+    if (std::string_view name = bound_class(locations[i] + offsetof(category_t, cls));
+        !name.empty())
+    {
+      cat->class_name_ = name;
+      continue;
+    }
+
+    const auto raw_cat = reader().read<category_t>(locations[i]);
+    Class* cls = raw_cat && raw_cat->cls ? get_or_create_class(decode_ptr(raw_cat->cls)) : nullptr;
+    if (cls == nullptr) {
+      ICDUMP_WARN("Can't resolve the class of the category {}", cat->name_);
+      continue;
+    }
+    attach_category(*cat, *cls);
   }
+
+  // Protocols only referenced by the categories
+  flush_protocols();
   return *this;
 }
 
-Parser& Parser::process_classes(LIEF::BinaryStream& mstream, LIEF::BinaryStream& classlist) {
-  const size_t nb_classes = classlist.size() / sizeof(uintptr_t);
+Parser& Parser::index_categories() {
+  for (const char* name : {"__objc_catlist", "__objc_catlist2"}) {
+    const section_t* sec = get_objc_section(*image_, name);
+    if (sec == nullptr) {
+      continue;
+    }
+    for (uintptr_t location : read_pointers(*this, *sec)) {
+      const auto raw_cat = reader().read<category_t>(location);
+      if (!raw_cat) {
+        ICDUMP_WARN("Can't read {}@0x{:010x}", name, location);
+        continue;
+      }
+
+      // Also done for the categories of the imported classes
+      if (raw_cat->protocols) {
+        get_or_create_protocols(decode_ptr(raw_cat->protocols));
+      }
+
+      // The categories of the classes imported from another image are not decoded
+      if (!bound_class(location + offsetof(category_t, cls)).empty()) {
+        continue;
+      }
+      if (raw_cat->cls == 0) {
+        ICDUMP_WARN("Can't read {}@0x{:010x}", name, location);
+        continue;
+      }
+      lazy_categories_[decode_ptr(raw_cat->cls)].push_back(location);
+    }
+  }
 
-  ICDUMP_DEBUG("__objc_classlist: #{}", nb_classes);
-  for (size_t i = 0; i < nb_classes; ++i) {
-    uintptr_t location = 0;
-    if (auto res = classlist.read<uintptr_t>()) {
-      ICDUMP_DEBUG("  __objc_classlist[{}]: 0x{:010x}", i, location);
-      location = decode_ptr(*res);
+  // Protocols only referenced by the categories
+  flush_protocols();
+  ICDUMP_DEBUG("__objc_catlist: {} classes with categories (lazy)", lazy_categories_.size());
+  return *this;
+}
+
+void Parser::attach_lazy_categories(uintptr_t address, Class& cls) {
+  const auto it = lazy_categories_.find(address);
+  if (it == std::end(lazy_categories_)) {
+    return;
+  }
+  for (uintptr_t location : it->second) {
+    if (Category* cat = Category::create(*this, location)) {
+      attach_category(*cat, cls);
     } else {
-      ICDUMP_WARN("Can't read __objc_classlist[{}]", i);
-      break;
+      ICDUMP_WARN("Can't read __objc_catlist@0x{:010x}", location);
     }
-    {
-      LIEF::ScopedStream scoped(mstream, location);
-      ICDUMP_DEBUG("  __objc_classlist@{:010x}", location);
-      if (std::unique_ptr<Class> cls = Class::create(*this)) {
-        metadata_->classes_lookup_[cls->name()] = cls.get();
-        metadata_->classes_.push_back(std::move(cls));
-      } else {
-        ICDUMP_WARN("Can't read __objc_classlist@0x{:010x}", location);
+  }
+}
+
+Parser& Parser::process_class_refs() {
+  const section_t* sec = get_objc_section(*image_, "__objc_classrefs");
+  if (sec == nullptr) {
+    return *this;
+  }
+
+  const std::vector<uintptr_t> pointers = read_pointers(*this, *sec);
+  metadata_->class_refs_.reserve(pointers.size());
+  for (size_t i = 0; i < pointers.size(); ++i) {
+    const uintptr_t address = sec->virtual_address + i * sizeof(uintptr_t);
+    if (std::string_view name = bound_class(address); !name.empty()) {
+      metadata_->class_refs_.push_back(name);
+    } else if (const Class* cls = get_or_create_class(pointers[i])) {
+      metadata_->class_refs_.push_back(cls->name_);
+    } else {
+      ICDUMP_DEBUG("Can't resolve __objc_classrefs[{}]", i);
+    }
+  }
+  return *this;
+}
+
+void Parser::attach_category(Category& cat, Class& cls) {
+  const auto concat = [this] (Class::methods_t lhs, Class::methods_t rhs) {
+    std::vector<Method*> methods(lhs.begin(), lhs.end());
+    methods.insert(methods.end(), rhs.begin(), rhs.end());
+    return arena().copy(methods);
+  };
+
+  cat.target_     = &cls;
+  cat.class_name_ = cls.name_;
+
+  if (!cat.instance_methods_.empty()) {
+    cls.methods_ = concat(cls.methods_, cat.instance_methods_);
+  }
+
+  if (!cat.class_methods_.empty()) {
+    if (cls.meta_ != nullptr) {
+      cls.meta_->methods_ = concat(cls.meta_->methods_, cat.class_methods_);
+    } else {
+      ICDUMP_WARN("Can't attach the class methods of {} (missing metaclass)", cat.to_string());
+    }
+  }
+
+  cls.protocols_.insert(cls.protocols_.end(), cat.protocols_.begin(), cat.protocols_.end());
+  cls.properties_.insert(cls.properties_.end(), cat.properties_.begin(), cat.properties_.end());
+}
+
+Parser& Parser::build_indexes() {
+  MethodStore& store = metadata_->method_store_;
+  ImpIndex& imps = metadata_->imp_index_;
+
+  // Classes which are not in __objc_classlist, sorted by
+  // address so that the rows don't depend on the hash map
+  std::vector<std::pair<uintptr_t, Class*>> others;
+  std::unordered_set<const Class*> visited;
+  for (Class* cls : metadata_->classes_) {
+    visited.insert(cls);
+    if (cls->meta_ != nullptr) {
+      visited.insert(cls->meta_);
+    }
+  }
+  for (const auto& [address, cls] : classes_) {
+    if (cls != nullptr && visited.find(cls) == std::end(visited)) {
+      others.emplace_back(address, cls);
+    }
+  }
+  std::sort(std::begin(others), std::end(others));
+
+  size_t nb_rows = 0;
+  for (const auto& [address, cls] : classes_) {
+    nb_rows += cls != nullptr ? cls->methods_.size() : 0;
+  }
+  for (const Protocol* proto : metadata_->protocols_) {
+    nb_rows += proto->required_methods_.size() + proto->opt_methods_.size();
+  }
+  // Methods of the categories are already counted with their (in-image) class
+  std::unordered_map<const Method*, const Category*> from_category;
+  for (const Category* cat : metadata_->categories_) {
+    for (const Method* meth : cat->instance_methods_) {
+      from_category.emplace(meth, cat);
+    }
+    for (const Method* meth : cat->class_methods_) {
+      from_category.emplace(meth, cat);
+    }
+    if (cat->target_ == nullptr) {
+      nb_rows += cat->instance_methods_.size() + cat->class_methods_.size();
+    }
+  }
+  // The views returned by append() remain valid as long as
+  // the columns are not reallocated
+  store.reserve(nb_rows);
+
+  visited.clear();
+  uint64_t max_imp = 0;
+  const auto add_imps = [&] (Class::methods_t methods, const Class* cls) {
+    for (const Method* meth : methods) {
+      if (meth->address() == 0) {
+        continue;
       }
+      const auto it = from_category.find(meth);
+      imps.starts_.push_back(meth->address());
+      imps.methods_.push_back(meth);
+      imps.classes_.push_back(cls);
+      imps.categories_.push_back(it != std::end(from_category) ? it->second : nullptr);
+      max_imp = std::max<uint64_t>(max_imp, meth->address());
+    }
+  };
+
+  const auto append = [&] (Class* cls, uint32_t owner) {
+    if (!visited.insert(cls).second) {
+      return;
     }
+    cls->methods_ = store.append(cls->methods_, owner, 0);
+    add_imps(cls->methods_, cls);
+  };
+
+  for (size_t i = 0; i < metadata_->classes_.size(); ++i) {
+    Class* cls = metadata_->classes_[i];
+    append(cls, i);
+    if (cls->meta_ != nullptr) {
+      append(cls->meta_, i);
+    }
+  }
+
+  for (const auto& [address, cls] : others) {
+    append(cls, MethodStore::NO_OWNER);
+  }
+
+  // Categories of the classes defined in another image
+  for (size_t i = 0; i < metadata_->categories_.size(); ++i) {
+    Category* cat = metadata_->categories_[i];
+    if (cat->target_ != nullptr) {
+      continue;
+    }
+    cat->instance_methods_ = store.append(cat->instance_methods_, i, MethodStore::CATEGORY);
+    cat->class_methods_    = store.append(cat->class_methods_, i, MethodStore::CATEGORY);
+    add_imps(cat->instance_methods_, nullptr);
+    add_imps(cat->class_methods_, nullptr);
+  }
+
+  for (size_t i = 0; i < metadata_->protocols_.size(); ++i) {
+    Protocol* proto = metadata_->protocols_[i];
+    proto->required_methods_ = store.append(proto->required_methods_, i, MethodStore::PROTOCOL);
+    proto->opt_methods_      = store.append(proto->opt_methods_, i,
+                                            MethodStore::PROTOCOL | MethodStore::OPTIONAL);
+  }
+
+  // The last method ends at most with its segment
+  uint64_t limit = max_imp;
+  if (const MachOImage::segment_t* seg = image_->segment_from_virtual_address(max_imp)) {
+    limit = seg->virtual_address + seg->virtual_size;
   }
+  imps.finalize(image_->function_starts(), limit);
+
+  metadata_->selector_index_.build(store);
   return *this;
 }
 
-uintptr_t Parser::decode_ptr(uintptr_t ptr) {
+std::vector<Method*> Parser::read_methods(uintptr_t address, bool is_instance) const {
+  const auto method_list = reader().read<method_list_t>(address);
+  if (!method_list) {
+    ICDUMP_WARN("Can't read method_list_t@0x{:010x}", address);
+    return {};
+  }
+
+  const bool is_small = method_list->flags() & method_list_t::IS_SMALL;
+  const uintptr_t methods_addr = address + sizeof(method_list_t);
+  const size_t sizeof_meth = is_small ? sizeof(small_method_t) : sizeof(big_method_t);
+  ICDUMP_DEBUG("     Count: {}", method_list->count);
+
+  std::vector<Method*> methods;
+  methods.reserve(method_list->count);
+  for (size_t i = 0; i < method_list->count; ++i) {
+    Method* method = Method::create(*this, methods_addr + i * sizeof_meth, is_small);
+    if (method == nullptr) {
+      ICDUMP_ERR("Error while processing method #{:d}", i);
+      break;
+    }
+    method->is_instance_ = is_instance;
+    methods.push_back(method);
+  }
+  return methods;
+}
+
+std::vector<Property*> Parser::read_properties(uintptr_t address) const {
+  const auto prop_list = reader().read<properties_list_t>(address);
+  if (!prop_list) {
+    ICDUMP_WARN("Can't read property_list_t@0x{:010x}", address);
+    return {};
+  }
+
+  std::vector<Property*> properties;
+  const uintptr_t props_addr = address + sizeof(properties_list_t);
+  for (size_t i = 0; i < prop_list->count; ++i) {
+    if (Property* prop = Property::create(*this, props_addr + i * sizeof(property_t))) {
+      properties.push_back(prop);
+    }
+  }
+  return properties;
+}
+
+std::string_view Parser::bound_symbol(uintptr_t address) const {
+  if (auto it = bindings_.find(address); it != std::end(bindings_)) {
+    return it->second;
+  }
+  return {};
+}
+
+std::string_view Parser::bound_class(uintptr_t address) const {
+  std::string_view symbol = bound_symbol(address);
+  if (symbol.empty()) {
+    return {};
+  }
+
+  for (std::string_view prefix : {OBJC_CLASS_PREFIX, OBJC_METACLASS_PREFIX}) {
+    if (symbol.substr(0, prefix.size()) == prefix) {
+      symbol.remove_prefix(prefix.size());
+      break;
+    }
+  }
+  return make_string(symbol);
+}
+
+uintptr_t Parser::decode_ptr(uintptr_t ptr) const {
+  if (fixups_ != nullptr) {
+    return fixups_->decode(ptr);
+  }
+
+  // Images without chained fixups: the pointers are absolute
+  // (or use threaded rebases for arm64e)
   uintptr_t decoded = ptr & ((1llu << 51) - 1);
   if (imagebase_ > 0 && decoded < imagebase_) {
     decoded += imagebase_;
@@ -20,24 +20,25 @@
 
 #include "ClangAST/utils.hpp"
 
-#include <LIEF/BinaryStream/BinaryStream.hpp>
+#include "iCDump/Arena.hpp"
+#include "MachOReader.hpp"
 
 namespace iCDump::ObjC {
-std::unique_ptr<Property> Property::create(Parser& parser) {
-  LIEF::BinaryStream& stream = parser.stream();
-  const auto raw_prop = stream.peek<ObjC::property_t>();
+Property* Property::create(const Parser& parser, uintptr_t address) {
+  const MachOReader& reader = parser.reader();
+  const auto raw_prop = reader.read<ObjC::property_t>(address);
   if (!raw_prop) {
     return nullptr;
   }
 
-  auto prop = std::make_unique<Property>();
+  auto prop = parser.arena().make<Property>();
 
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_prop->name))) {
-    prop->name_ = std::move(*res);
+  if (auto res = parser.string_at(parser.decode_ptr(raw_prop->name))) {
+    prop->name_ = *res;
   }
 
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_prop->attributes))) {
-    prop->attributes_ = std::move(*res);
+  if (auto res = parser.string_at(parser.decode_ptr(raw_prop->attributes))) {
+    prop->attributes_ = *res;
   }
   return prop;
 }
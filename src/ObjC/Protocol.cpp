@@ -12,8 +12,6 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include <LIEF/BinaryStream/BinaryStream.hpp>
-
 #include "iCDump/ObjC/Protocol.hpp"
 #include "iCDump/ObjC/Types.hpp"
 #include "iCDump/ObjC/Parser.hpp"
@@ -22,120 +20,70 @@
 #include "iCDump/config.hpp"
 
 #include "log.hpp"
+#include "iCDump/Arena.hpp"
+#include "MachOReader.hpp"
 
 #include "ClangAST/utils.hpp"
 
 namespace iCDump::ObjC {
 Protocol::Protocol() = default;
 
-std::unique_ptr<Protocol> Protocol::create(Parser& parser) {
-  LIEF::BinaryStream& stream = parser.stream();
-  const auto raw_proto = stream.peek<ObjC::protocol_t>();
+Protocol* Protocol::create(const Parser& parser, uintptr_t address) {
+  const MachOReader& reader = parser.reader();
+  const auto raw_proto = reader.read<ObjC::protocol_t>(address);
   if (!raw_proto) {
     return nullptr;
   }
 
-  auto protocol = std::make_unique<Protocol>();
+  auto protocol = parser.arena().make<Protocol>();
 
-  if (auto res = stream.peek_string_at(parser.decode_ptr(raw_proto->mangled_name))) {
-    protocol->mangled_name_ = std::move(*res);
-  }
+  // Append the methods of the method_list_t located at the given address
+  const auto process_methods = [&] (uintptr_t list_addr, bool is_instance,
+                                    std::vector<Method*>& methods) {
+    const std::vector<Method*> list = parser.read_methods(list_addr, is_instance);
+    methods.insert(methods.end(), list.begin(), list.end());
+  };
 
-  if (raw_proto->protocols) {
-    // TODO(romain): To be processed
+  if (auto res = parser.string_at(parser.decode_ptr(raw_proto->mangled_name))) {
+    protocol->mangled_name_ = *res;
   }
 
+  // The adopted protocols (raw_proto->protocols) are resolved by the Parser
+
+  std::vector<Method*> required_methods;
+  std::vector<Method*> opt_methods;
+
   if (raw_proto->instance_methods) {
     ICDUMP_DEBUG("[->] protocol.instance_methods");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_proto->instance_methods));
-    if (const auto method_list = stream.read<ObjC::method_list_t>()) {
-      const bool is_small = method_list->flags() & ObjC::method_list_t::IS_SMALL;
-      const size_t sizeof_meth = is_small ? sizeof(ObjC::small_method_t) : sizeof(ObjC::big_method_t);
-      const size_t methods_addr = stream.pos();
-      for (size_t i = 0; i < method_list->count; ++i) {
-        stream.setpos(methods_addr + i * sizeof_meth);
-        if (std::unique_ptr<Method> method = Method::create(parser, is_small)) {
-          method->is_instance_ = true;
-          protocol->required_methods_.push_back(std::move(method));
-        }
-      }
-    } else {
-      ICDUMP_ERR("Methods list seems corrupted");
-    }
+    process_methods(parser.decode_ptr(raw_proto->instance_methods),
+                    /* is_instance */true, required_methods);
   }
 
   if (raw_proto->class_methods) {
     ICDUMP_DEBUG("[->] protocol.class_methods");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_proto->class_methods));
-    if (const auto method_list = stream.read<ObjC::method_list_t>()) {
-      const size_t methods_addr = stream.pos();
-      const bool is_small = method_list->flags() & ObjC::method_list_t::IS_SMALL;
-      const size_t sizeof_meth = is_small ? sizeof(ObjC::small_method_t) : sizeof(ObjC::big_method_t);
-      for (size_t i = 0; i < method_list->count; ++i) {
-        stream.setpos(methods_addr + i * sizeof_meth);
-        if (std::unique_ptr<Method> method = Method::create(parser, is_small)) {
-          method->is_instance_ = false;
-          protocol->required_methods_.push_back(std::move(method));
-        }
-      }
-    } else {
-      ICDUMP_ERR("Methods list seems corrupted");
-    }
+    process_methods(parser.decode_ptr(raw_proto->class_methods),
+                    /* is_instance */false, required_methods);
   }
 
   if (raw_proto->optional_instance_methods) {
     ICDUMP_DEBUG("[->] protocol.optional_instance_methods");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_proto->optional_instance_methods));
-    if (const auto method_list = stream.read<ObjC::method_list_t>()) {
-      const bool is_small = method_list->flags() & ObjC::method_list_t::IS_SMALL;
-      const size_t methods_addr = stream.pos();
-      const size_t sizeof_meth = is_small ? sizeof(ObjC::small_method_t) : sizeof(ObjC::big_method_t);
-      ICDUMP_DEBUG("     Count: {}", method_list->count);
-      for (size_t i = 0; i < method_list->count; ++i) {
-        ICDUMP_DEBUG("     protocol.optional_instance_methods[{}]", i);
-        stream.setpos(methods_addr + i * sizeof_meth);
-        if (std::unique_ptr<Method> method = Method::create(parser, is_small)) {
-          method->is_instance_ = true;
-          protocol->opt_methods_.push_back(std::move(method));
-        }
-      }
-    } else {
-      ICDUMP_ERR("Methods list seems corrupted");
-    }
+    process_methods(parser.decode_ptr(raw_proto->optional_instance_methods),
+                    /* is_instance */true, opt_methods);
   }
 
   if (raw_proto->optional_class_methods) {
     ICDUMP_DEBUG("[->] protocol.optional_class_methods");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_proto->optional_class_methods));
-    if (const auto method_list = stream.read<ObjC::method_list_t>()) {
-      const bool is_small = method_list->flags() & ObjC::method_list_t::IS_SMALL;
-      const size_t sizeof_meth = is_small ? sizeof(ObjC::small_method_t) : sizeof(ObjC::big_method_t);
-      const size_t methods_addr = stream.pos();
-      for (size_t i = 0; i < method_list->count; ++i) {
-        stream.setpos(methods_addr + i * sizeof_meth);
-        if (std::unique_ptr<Method> method = Method::create(parser, is_small)) {
-          method->is_instance_ = false;
-          protocol->opt_methods_.push_back(std::move(method));
-        }
-      }
-    } else {
-      ICDUMP_ERR("Methods list seems corrupted");
-    }
+    process_methods(parser.decode_ptr(raw_proto->optional_class_methods),
+                    /* is_instance */false, opt_methods);
   }
 
+  protocol->required_methods_ = parser.arena().copy(required_methods);
+  protocol->opt_methods_      = parser.arena().copy(opt_methods);
+
 
   if (raw_proto->instance_properties) {
     ICDUMP_DEBUG("[->] protocol.instance_properties");
-    LIEF::ScopedStream scoped(stream, parser.decode_ptr(raw_proto->instance_properties));
-    if (const auto prop_list = stream.read<ObjC::properties_list_t>()) {
-      const size_t props_addr = stream.pos();
-      for (size_t i = 0; i < prop_list->count; ++i) {
-        stream.setpos(props_addr + i * sizeof(ObjC::property_t));
-        if (std::unique_ptr<Property> prop = Property::create(parser)) {
-          protocol->properties_.push_back(std::move(prop));
-        }
-      }
-    }
+    protocol->properties_ = parser.read_properties(parser.decode_ptr(raw_proto->instance_properties));
   }
   return protocol;
 }
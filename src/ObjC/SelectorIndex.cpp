@@ -0,0 +1,90 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+
+#include "iCDump/ObjC/SelectorIndex.hpp"
+
+namespace iCDump::ObjC {
+static constexpr uint32_t NO_POSITION = static_cast<uint32_t>(-1);
+
+void SelectorIndex::build(const MethodStore& store) {
+  store_ = &store;
+  const std::vector<id_t>& rows = store.selectors();
+
+  // Selectors and type encodings share the same ids: only
+  // the ids used as a selector are indexed
+  std::vector<uint32_t> counts(store.nb_strings(), 0);
+  for (id_t id : rows) {
+    ++counts[id];
+  }
+
+  for (id_t id = 0; id < counts.size(); ++id) {
+    if (counts[id] > 0) {
+      selectors_.push_back(id);
+    }
+  }
+  std::sort(selectors_.begin(), selectors_.end(),
+            [&store] (id_t lhs, id_t rhs) {
+              return store.string(lhs) < store.string(rhs);
+            });
+
+  positions_.assign(counts.size(), NO_POSITION);
+  offsets_.resize(selectors_.size() + 1, 0);
+  for (size_t i = 0; i < selectors_.size(); ++i) {
+    positions_[selectors_[i]] = i;
+    offsets_[i + 1] = offsets_[i] + counts[selectors_[i]];
+  }
+
+  // Counting sort of the rows: the postings are in the order of the rows
+  std::vector<uint32_t> cursors(offsets_.begin(), offsets_.end() - 1);
+  postings_.resize(rows.size());
+  for (size_t row = 0; row < rows.size(); ++row) {
+    postings_[cursors[positions_[rows[row]]]++] = row;
+  }
+}
+
+SelectorIndex::postings_t SelectorIndex::postings(id_t selector) const {
+  if (selector >= positions_.size() || positions_[selector] == NO_POSITION) {
+    return {};
+  }
+  const uint32_t pos = positions_[selector];
+  return {postings_.data() + offsets_[pos], offsets_[pos + 1] - offsets_[pos]};
+}
+
+SelectorIndex::postings_t SelectorIndex::find(std::string_view selector) const {
+  if (store_ == nullptr) {
+    return {};
+  }
+  return postings(store_->find(selector));
+}
+
+span<const SelectorIndex::id_t> SelectorIndex::prefix(std::string_view prefix) const {
+  if (store_ == nullptr) {
+    return {};
+  }
+  const auto start = std::lower_bound(selectors_.begin(), selectors_.end(), prefix,
+      [this] (id_t id, std::string_view value) {
+        return store_->string(id) < value;
+      });
+
+  // The selectors sharing the prefix are contiguous
+  const auto end = std::partition_point(start, selectors_.end(),
+      [this, prefix] (id_t id) {
+        return store_->string(id).substr(0, prefix.size()) == prefix;
+      });
+  return {selectors_.data() + (start - selectors_.begin()), static_cast<size_t>(end - start)};
+}
+
+}
@@ -0,0 +1,81 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <mutex>
+
+#include "iCDump/ObjC/TypeCache.hpp"
+#include "iCDump/ObjC/TypesEncoding.hpp"
+#include "log.hpp"
+
+#include "iCDump/Arena.hpp"
+
+namespace iCDump::ObjC {
+TypeCache::TypeCache() :
+  arena_{std::make_unique<Arena>()}
+{}
+
+TypeCache::~TypeCache() = default;
+
+TypeCache::types_t TypeCache::decode(std::string_view encoded) {
+  {
+    std::shared_lock lock(mutex_);
+    if (auto it = encodings_.find(encoded); it != std::end(encodings_)) {
+      return it->second;
+    }
+  }
+
+  // Decode outside of the lock as another thread could insert
+  // the same encoding in the meantime
+  const std::string str(encoded);
+  std::vector<std::string_view> components;
+  ObjC::types_t decoded = decode_type(str, components);
+  if (decoded.empty()) {
+    ICDUMP_ERR("Decoding {} failed", encoded);
+  }
+
+  std::unique_lock lock(mutex_);
+  if (auto it = encodings_.find(encoded); it != std::end(encodings_)) {
+    return it->second;
+  }
+
+  std::vector<const Type*> types;
+  types.reserve(decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    types.push_back(intern(components[i], std::move(decoded[i])));
+  }
+  types_t interned = arena_->copy(types);
+  encodings_.emplace(arena_->copy(encoded), interned);
+  return interned;
+}
+
+const Type* TypeCache::intern(std::string_view encoded, std::unique_ptr<Type> type) {
+  if (auto it = components_.find(encoded); it != std::end(components_)) {
+    return it->second;
+  }
+  const Type* interned = types_.emplace_back(std::move(type)).get();
+  components_.emplace(arena_->copy(encoded), interned);
+  return interned;
+}
+
+size_t TypeCache::size() const {
+  std::shared_lock lock(mutex_);
+  return encodings_.size();
+}
+
+size_t TypeCache::nb_types() const {
+  std::shared_lock lock(mutex_);
+  return types_.size();
+}
+
+}
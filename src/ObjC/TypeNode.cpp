@@ -0,0 +1,184 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "iCDump/ObjC/TypeNode.hpp"
+
+#include "iCDump/Arena.hpp"
+#include "TypeWalker.hpp"
+
+namespace iCDump::ObjC {
+
+namespace {
+//! Build the TypeNode trees from the callbacks of the TypeWalker
+class NodeBuilder {
+  public:
+  explicit NodeBuilder(Arena& arena) :
+    arena_{arena}
+  {}
+
+  inline const TypeNode* first() const {
+    return first_;
+  }
+
+  bool stopped() const {
+    return false;
+  }
+
+  void enter_type() {}
+
+  void leave_type(std::string_view) {
+    if (current_ == nullptr) {
+      return;
+    }
+    if (last_ == nullptr) {
+      first_ = current_;
+    } else {
+      last_->next = current_;
+    }
+    last_    = current_;
+    current_ = nullptr;
+  }
+
+  void visit_specifier(OBJC_TYPE_SPECIFIERS spec) {
+    specifiers_ |= specifier_bit(spec);
+  }
+
+  void visit_leaf(OBJC_TYPES type) {
+    deliver(make(type));
+  }
+
+  void visit_object(std::string_view name) {
+    TypeNode* node = make(OBJC_TYPES::OBJECT);
+    node->name = name;
+    deliver(node);
+  }
+
+  void visit_bitfield(size_t size) {
+    TypeNode* node = make(OBJC_TYPES::BIT_FIELD);
+    node->size = size;
+    deliver(node);
+  }
+
+  void enter_pointer() {
+    open(make(OBJC_TYPES::POINTER));
+  }
+
+  void leave_pointer(bool valid) {
+    close(valid);
+  }
+
+  void enter_array(size_t dim) {
+    TypeNode* node = make(OBJC_TYPES::ARRAY);
+    node->size = dim;
+    open(node);
+  }
+
+  void leave_array(bool valid) {
+    close(valid);
+  }
+
+  void enter_record(OBJC_TYPES type, std::string_view name) {
+    TypeNode* node = make(type);
+    node->name = name;
+    open(node);
+  }
+
+  void visit_field(std::string_view name) {
+    FieldNode* field = arena_.make<FieldNode>();
+    field->name = name;
+    if (top_->last_field == nullptr) {
+      top_->node->fields = field;
+    } else {
+      top_->last_field->next = field;
+    }
+    top_->last_field = field;
+  }
+
+  void leave_record(bool valid) {
+    close(valid);
+  }
+
+  void invalid() {
+    specifiers_ = 0;
+    deliver(nullptr);
+  }
+
+  private:
+  //! Composite type being built. The frames are recycled through ``free_``
+  struct frame_t {
+    TypeNode* node = nullptr;
+    FieldNode* last_field = nullptr;
+    frame_t* parent = nullptr;
+  };
+
+  TypeNode* make(OBJC_TYPES type) {
+    TypeNode* node = arena_.make<TypeNode>();
+    node->type       = type;
+    node->specifiers = specifiers_;
+    specifiers_ = 0;
+    return node;
+  }
+
+  void open(TypeNode* node) {
+    frame_t* frame = free_;
+    if (frame != nullptr) {
+      free_ = frame->parent;
+    } else {
+      frame = arena_.make<frame_t>();
+    }
+    frame->node       = node;
+    frame->last_field = nullptr;
+    frame->parent     = top_;
+    top_ = frame;
+  }
+
+  void close(bool valid) {
+    frame_t* frame = top_;
+    top_ = frame->parent;
+    frame->parent = free_;
+    free_ = frame;
+    deliver(valid ? frame->node : nullptr);
+  }
+
+  //! Give a decoded node (nullptr if it is invalid) to the enclosing type
+  void deliver(TypeNode* node) {
+    if (top_ == nullptr) {
+      current_ = node;
+      return;
+    }
+    TypeNode* parent = top_->node;
+    if (parent->type == OBJC_TYPES::STRUCT || parent->type == OBJC_TYPES::UNION) {
+      top_->last_field->type = node;
+      return;
+    }
+    // For an array, the last element's type wins
+    parent->subtype = node;
+  }
+
+  Arena& arena_;
+  type_specifiers_mask_t specifiers_ = 0;
+  frame_t* top_  = nullptr;
+  frame_t* free_ = nullptr;
+  TypeNode* current_ = nullptr;
+  const TypeNode* first_ = nullptr;
+  TypeNode* last_ = nullptr;
+};
+}
+
+const TypeNode* decode_nodes(std::string_view encoded, Arena& arena) {
+  NodeBuilder builder(arena);
+  TypeWalker<NodeBuilder>(encoded, builder).walk();
+  return builder.first();
+}
+}
@@ -0,0 +1,25 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "iCDump/ObjC/TypeVisitor.hpp"
+
+#include "TypeWalker.hpp"
+
+namespace iCDump::ObjC {
+TypeVisitor::~TypeVisitor() = default;
+
+void walk_type(std::string_view encoded, TypeVisitor& visitor) {
+  TypeWalker<TypeVisitor>(encoded, visitor).walk();
+}
+}
@@ -0,0 +1,259 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_OBJC_TYPE_WALKER_H_
+#define ICDUMP_OBJC_TYPE_WALKER_H_
+#include <algorithm>
+#include <string_view>
+
+#include "iCDump/ObjC/TypesEncoding.hpp"
+#include "log.hpp"
+
+namespace iCDump::ObjC {
+
+//! Parser of the type encodings which reports the types to a visitor
+//! with the callbacks of TypeVisitor (plus ``bool stopped() const``).
+//!
+//! The visitor is a template parameter so that the decoders built on top
+//! of the walker (decode_type(), decode_nodes()) don't pay for virtual calls.
+template<class V>
+class TypeWalker {
+  public:
+  TypeWalker(std::string_view encoded, V& visitor) :
+    it_{encoded.data()},
+    end_{encoded.data() + encoded.size()},
+    visitor_{visitor}
+  {}
+
+  void walk() {
+    while (it_ != end_ && !visitor_.stopped()) {
+      // Stack offset of the previous type
+      skip_digits();
+      if (it_ == end_) {
+        break;
+      }
+      const char* start = it_;
+      visitor_.enter_type();
+      if (OBJC_TYPE_SPECIFIERS spec = process_specifier(); spec != OBJC_TYPE_SPECIFIERS::UNKNOWN) {
+        visitor_.visit_specifier(spec);
+      }
+      process();
+      visitor_.leave_type(view(start));
+    }
+  }
+
+  private:
+  static bool is_digit(char c) {
+    return '0' <= c && c <= '9';
+  }
+
+  std::string_view view(const char* start) const {
+    return {start, static_cast<size_t>(it_ - start)};
+  }
+
+  void skip_digits() {
+    while (it_ != end_ && is_digit(*it_)) {
+      ++it_;
+    }
+  }
+
+  bool read_number(size_t& value) {
+    const char* start = it_;
+    value = 0;
+    while (it_ != end_ && is_digit(*it_)) {
+      value = value * 10 + (*it_++ - '0');
+    }
+    return it_ != start;
+  }
+
+  OBJC_TYPE_SPECIFIERS process_specifier() {
+    if (it_ == end_) {
+      return OBJC_TYPE_SPECIFIERS::UNKNOWN;
+    }
+    const OBJC_TYPE_SPECIFIERS spec = type_specifier_id(*it_);
+    if (spec != OBJC_TYPE_SPECIFIERS::UNKNOWN) {
+      ++it_;
+    }
+    return spec;
+  }
+
+  std::string_view read_opt_name() {
+    static constexpr char DELIM = '"';
+    if (it_ == end_ || *it_ != DELIM) {
+      return {};
+    }
+    const char* start = ++it_;
+    while (it_ != end_ && *it_ != DELIM) {
+      ++it_;
+    }
+    std::string_view name = view(start);
+    if (it_ != end_) {
+      ++it_;
+    }
+    return name;
+  }
+
+  //! Walk the next type and return false if it can't be decoded
+  bool process() {
+    skip_digits();
+    for (OBJC_TYPE_SPECIFIERS spec = process_specifier();
+         spec != OBJC_TYPE_SPECIFIERS::UNKNOWN; spec = process_specifier())
+    {
+      visitor_.visit_specifier(spec);
+    }
+    if (it_ == end_) {
+      visitor_.invalid();
+      return false;
+    }
+
+    const char c = *it_++;
+    if (!is_type_code(c)) {
+      ICDUMP_ERR("Unsupported type: {} ({})", c, std::string_view(it_ - 1, end_ - it_ + 1));
+      visitor_.invalid();
+      return false;
+    }
+
+    const OBJC_TYPES type = type_id(c);
+    switch (type) {
+      case OBJC_TYPES::ARRAY:     return process_array();
+      case OBJC_TYPES::STRUCT:    return process_record(OBJC_TYPES::STRUCT);
+      case OBJC_TYPES::UNION:     return process_record(OBJC_TYPES::UNION);
+      case OBJC_TYPES::BIT_FIELD: return process_bitfield();
+      case OBJC_TYPES::POINTER:   return process_pointer();
+      case OBJC_TYPES::OBJECT:
+        {
+          // Special case: @? --> block
+          if (it_ != end_ && *it_ == '?') {
+            ++it_;
+            visitor_.visit_leaf(OBJC_TYPES::BLOCK);
+            return true;
+          }
+          visitor_.visit_object(read_opt_name());
+          return true;
+        }
+      default:
+        {
+          // Primitive types, CLASS, SELECTOR and UNKNOWN ('?')
+          visitor_.visit_leaf(type);
+          return true;
+        }
+    }
+  }
+
+  bool process_pointer() {
+    visitor_.enter_pointer();
+    // Special case: ^? --> void*
+    if (it_ != end_ && *it_ == '?') {
+      ++it_;
+      visitor_.visit_leaf(OBJC_TYPES::VOID);
+      visitor_.leave_pointer(true);
+      return true;
+    }
+    const char* start = it_;
+    const bool valid = process();
+    if (!valid) {
+      ICDUMP_ERR("Can't resolve pointer type: {}",
+                 std::string_view(start, std::min<size_t>(3, end_ - start)));
+    }
+    visitor_.leave_pointer(valid);
+    return valid;
+  }
+
+  bool process_array() {
+    size_t dim = 0;
+    if (!read_number(dim)) {
+      ICDUMP_ERR("Arraysize is null");
+      visitor_.invalid();
+      return false;
+    }
+    visitor_.enter_array(dim);
+    while (it_ != end_ && *it_ != ']') {
+      if (visitor_.stopped()) {
+        return false;
+      }
+      process();
+    }
+    if (it_ == end_) {
+      ICDUMP_ERR("Can't find closing array token");
+      visitor_.leave_array(false);
+      return false;
+    }
+    ++it_;
+    visitor_.leave_array(true);
+    return true;
+  }
+
+  bool process_record(OBJC_TYPES type) {
+    static constexpr char NAME_DELIM = '=';
+    const bool is_struct = type == OBJC_TYPES::STRUCT;
+    const char end_delim = is_struct ? '}' : ')';
+
+    // Anonymous structure or union
+    if (it_ != end_ && *it_ == '?') {
+      ++it_;
+    }
+    // Contrary to a structure, the name of a union only ends with '='
+    const char* start = it_;
+    while (it_ != end_ && *it_ != NAME_DELIM && (!is_struct || *it_ != end_delim)) {
+      ++it_;
+    }
+    visitor_.enter_record(type, view(start));
+
+    if (it_ != end_ && *it_ == NAME_DELIM) {
+      ++it_;
+    }
+    // No field eg. ^{MyStruct}
+    if (it_ != end_ && *it_ == end_delim) {
+      ++it_;
+      visitor_.leave_record(true);
+      return true;
+    }
+
+    while (it_ != end_ && *it_ != end_delim) {
+      if (visitor_.stopped()) {
+        return false;
+      }
+      visitor_.visit_field(read_opt_name());
+      process();
+    }
+    if (it_ == end_) {
+      if (is_struct) {
+        ICDUMP_ERR("Expecting token '}}'");
+      }
+      visitor_.leave_record(false);
+      return false;
+    }
+    ++it_;
+    visitor_.leave_record(true);
+    return true;
+  }
+
+  bool process_bitfield() {
+    size_t size = 0;
+    if (!read_number(size)) {
+      ICDUMP_ERR("num_str is null");
+      visitor_.invalid();
+      return false;
+    }
+    visitor_.visit_bitfield(size);
+    return true;
+  }
+
+  const char* it_ = nullptr;
+  const char* end_ = nullptr;
+  V& visitor_;
+};
+
+}
+#endif
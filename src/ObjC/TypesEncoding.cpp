@@ -13,308 +13,212 @@
  * limitations under the License.
  */
 #include "iCDump/ObjC/TypesEncoding.hpp"
-#include "log.hpp"
 
-namespace iCDump::ObjC {
-
-inline bool is_digit(char c) {
-  return '0' <= c && c <= '9';
-}
-
-inline size_t get_pos(const std::string& encoded, std::string::const_iterator& it) {
-  return std::distance(std::begin(encoded), it);
-}
-
-OBJC_TYPE_SPECIFIERS process_specifier(const std::string& encoded, std::string::const_iterator& it);
-std::unique_ptr<Type> process(const std::string& encoded, std::string::const_iterator& it);
+#include "TypeWalker.hpp"
 
-//std::string object_name(const std::string& encoded, std::string::const_iterator& it, size_t& pos) {
-//  char quote = *it;
-//  ++it;
-//  ICDUMP_INFO("{}", encoded.substr(get_pos(encoded, it)));
-//  size_t token_pos = encoded.find_first_of('"', pos);
-//  if (token_pos == std::string::npos) {
-//    ICDUMP_ERR("Can't find '\"' token");
-//    return "";
-//  }
-//  std::string name = encoded.substr(pos, token_pos - pos);
-//  const size_t delta = name.size() + 1; // +1 for the ending '"'
-//  pos += delta;
-//  it  += delta;
-//  return name;
-//}
+namespace iCDump::ObjC {
 
-void skip_digits(const std::string& encoded, std::string::const_iterator& it) {
-  while (it != std::end(encoded) && is_digit(*it)) {
-    ++it;
+namespace {
+//! Build the Type trees from the callbacks of the TypeWalker
+class TypeBuilder {
+  public:
+  //! Builder of the calling thread. Its frames are kept from one
+  //! decoding to the other so that they are allocated once.
+  static TypeBuilder& get(std::vector<std::string_view>* encodings) {
+    thread_local TypeBuilder builder;
+    builder.encodings_ = encodings;
+    builder.depth_     = 0;
+    builder.specifiers_.clear();
+    builder.current_.reset();
+    builder.types_.clear();
+    return builder;
   }
-}
 
-std::string read_opt_name(const std::string& encoded, std::string::const_iterator& it) {
-  static constexpr char DELIM = '"';
-  if (it == std::end(encoded) || *it != DELIM) {
-    return {};
-  }
-  char __delim = *it++;
-  std::string name;
-  for (; it != std::end(encoded) && *it != DELIM; ++it) {
-    name += *it;
+  inline types_t take() {
+    return std::move(types_);
   }
-  if (it != std::end(encoded) && *it == DELIM) {
-    ++it;
-  }
-  return name;
-}
 
-std::unique_ptr<StructTy> process_structure(const std::string& encoded, std::string::const_iterator& it) {
-  static constexpr char NAME_DELIM       = '=';
-  static constexpr char STRUCT_END_DELIM = '}';
-  //ICDUMP_DEBUG("Reading structure from {}", encoded.substr(pos));
-  std::string struct_name;
-  if (it != std::end(encoded) && *it == '?') {
-    // struct_name = "anonymous";
-    ++it;
-  }
-  while (it != std::end(encoded) && *it != NAME_DELIM && *it != STRUCT_END_DELIM) {
-    struct_name += *it++;
+  bool stopped() const {
+    return false;
   }
 
-  //ICDUMP_INFO("Struct name: {}", struct_name);
+  void enter_type() {}
 
-  if (it != std::end(encoded) && *it == STRUCT_END_DELIM) {
-    // No field eg. ^{MyStruct}
-    ++it;
-    return std::make_unique<StructTy>(struct_name, StructTy::attributes_t{});
-  }
-
-  if (it != std::end(encoded) && *it == NAME_DELIM) {
-    ++it;
-  }
-  StructTy::attributes_t attributes;
-  if (it != std::end(encoded) && *it == STRUCT_END_DELIM) {
-    ++it;
-  } else {
-    //ICDUMP_DEBUG("Reading fields from {}", encoded.substr(pos));
-    while(it != std::end(encoded) && *it != STRUCT_END_DELIM) {
-      std::string name = read_opt_name(encoded, it);
-      std::unique_ptr<Type> field_type = process(encoded, it);
-      attributes.emplace_back(name, std::move(field_type));
+  void leave_type(std::string_view encoding) {
+    if (current_ == nullptr) {
+      return;
     }
-    if (it != std::end(encoded) && *it == STRUCT_END_DELIM) {
-      ++it;
-      //ICDUMP_DEBUG("End struct");
-      return std::make_unique<StructTy>(struct_name, std::move(attributes));
+    // A method's prototype has a few types: skip the first regrowths
+    if (types_.empty()) {
+      types_.reserve(RESERVED_TYPES);
+    }
+    types_.push_back(std::move(current_));
+    if (encodings_ != nullptr) {
+      encodings_->push_back(encoding);
     }
-    ICDUMP_ERR("Expecting token '}}' ('{}')", *it);
-    return nullptr;
   }
-  return std::make_unique<StructTy>(struct_name, std::move(attributes));
-}
 
-std::unique_ptr<UnionTy> process_union(const std::string& encoded, std::string::const_iterator& it) {
-  static constexpr char NAME_DELIM       = '=';
-  static constexpr char UNION_END_DELIM = ')';
-  //ICDUMP_DEBUG("Reading union from {}", encoded.substr(pos));
-  std::string union_name;
-  if (it != std::end(encoded) && *it == '?') {
-    // Anonymous union
-    //union_name = "anonymous";
-    ++it;
-  }
-  while (it != std::end(encoded) && *it != NAME_DELIM) {
-    union_name += *it++;
+  void visit_specifier(OBJC_TYPE_SPECIFIERS spec) {
+    specifiers_.insert(spec);
   }
-  if (it != std::end(encoded) && *it == NAME_DELIM) {
-    ++it;
-  }
-  //ICDUMP_INFO("Union name: {}", union_name);
 
-  UnionTy::attributes_t attributes;
-  if (it != std::end(encoded) && *it == UNION_END_DELIM) {
-    ++it;
-  } else {
-    //ICDUMP_DEBUG("Reading fields from {}", encoded.substr(pos));
-    while(it != std::end(encoded) && *it != UNION_END_DELIM) {
-      std::string name = read_opt_name(encoded, it);
-      //if (!name.empty()) {
-      //  ICDUMP_DEBUG("Field: {}", name);
-      //}
-      std::unique_ptr<Type> field_type = process(encoded, it);
-      attributes.emplace_back(name, std::move(field_type));
-    }
-    if (it != std::end(encoded) && *it == UNION_END_DELIM) {
-      ++it;
-      //ICDUMP_DEBUG("End union");
-      return std::make_unique<UnionTy>(union_name, std::move(attributes));
+  void visit_leaf(OBJC_TYPES type) {
+    switch (type) {
+      case OBJC_TYPES::CLASS:    return deliver(qualify(std::make_unique<ClassTy>()));
+      case OBJC_TYPES::SELECTOR: return deliver(qualify(std::make_unique<SelectorTy>()));
+      case OBJC_TYPES::BLOCK:    return deliver(qualify(std::make_unique<BlockTy>()));
+      case OBJC_TYPES::UNKNOWN:  return deliver(qualify(std::make_unique<UnknownTy>()));
+      default:                   return deliver(qualify(std::make_unique<PrimitiveTy>(type)));
     }
-    // error
-    return nullptr;
-
   }
-  return std::make_unique<UnionTy>(union_name, std::move(attributes));
-}
 
-std::string read_str_number(const std::string& encoded, std::string::const_iterator& it) {
-  std::string n;
-  while (it != std::end(encoded) && is_digit(*it)) {
-    n = *it++;
+  void visit_object(std::string_view name) {
+    deliver(qualify(std::make_unique<ObjectTy>(std::string(name))));
   }
-  return n;
-}
 
-std::unique_ptr<BitFieldTy> process_bitfield(const std::string& encoded,
-                                             std::string::const_iterator& it) {
-  const std::string num_str = read_str_number(encoded, it);
-  if (num_str.empty()) {
-    ICDUMP_ERR("num_str is null");
-    return nullptr;
+  void visit_bitfield(size_t size) {
+    deliver(qualify(std::make_unique<BitFieldTy>(size)));
   }
-  char* endp;
-  size_t fsize = std::strtoull(num_str.c_str(), &endp, 10);
-  return std::make_unique<BitFieldTy>(fsize);
-}
-
-
 
-std::unique_ptr<ArrayTy> process_array(const std::string& encoded, std::string::const_iterator& it) {
-  const std::string array_size_str = read_str_number(encoded, it);
-  if (array_size_str.empty()) {
-    ICDUMP_ERR("Arraysize is null");
-    return nullptr;
+  void enter_pointer() {
+    push(OBJC_TYPES::POINTER);
   }
-  char* endp;
-  size_t array_size = std::strtoull(array_size_str.c_str(), &endp, 10);
 
-  //ICDUMP_DEBUG("Reading array type from {}", encoded.substr(pos));
-  std::unique_ptr<Type> underlying_type;
-  while(it != std::end(encoded) && *it != ']') {
-    underlying_type = process(encoded, it);
+  void leave_pointer(bool valid) {
+    frame_t& frame = pop();
+    deliver(valid ? qualify(std::make_unique<PointerTy>(std::move(frame.subtype)), frame) : nullptr);
   }
 
-  if (it != std::end(encoded) && *it == ']') {
-    ++it;
-    return std::make_unique<ArrayTy>(array_size, std::move(underlying_type));
+  void enter_array(size_t dim) {
+    push(OBJC_TYPES::ARRAY).dim = dim;
   }
-  ICDUMP_ERR("Can't find closing array token");
-  return nullptr;
-}
-
-std::unique_ptr<Type> process(const std::string& encoded, std::string::const_iterator& it) {
-  skip_digits(encoded, it);
 
-  //ICDUMP_DEBUG("Reading token at {:d}: {}", pos, encoded.substr(pos));
+  void leave_array(bool valid) {
+    frame_t& frame = pop();
+    if (!valid) {
+      return deliver(nullptr);
+    }
+    deliver(qualify(std::make_unique<ArrayTy>(frame.dim, std::move(frame.subtype)), frame));
+  }
 
-  if (it == std::end(encoded)) {
-    return nullptr;
+  void enter_record(OBJC_TYPES type, std::string_view name) {
+    push(type).name = name;
   }
 
-  {
-    OBJC_TYPE_SPECIFIERS spec = OBJC_TYPE_SPECIFIERS::UNKNOWN;
-    do {
-      spec = process_specifier(encoded, it);
-    } while (it != std::end(encoded) && spec != OBJC_TYPE_SPECIFIERS::UNKNOWN);
+  void visit_field(std::string_view name) {
+    frames_[depth_ - 1].field_name = name;
+  }
 
-    if (it == std::end(encoded)) {
-      return nullptr;
+  void leave_record(bool valid) {
+    frame_t& frame = pop();
+    if (!valid) {
+      return deliver(nullptr);
+    }
+    if (frame.type == OBJC_TYPES::STRUCT) {
+      auto record = std::make_unique<StructTy>(std::string(frame.name), std::move(frame.attributes));
+      return deliver(qualify(std::move(record), frame));
+    }
+    auto record = std::make_unique<UnionTy>(std::string(frame.name), std::move(frame.attributes));
+    deliver(qualify(std::move(record), frame));
+  }
+
+  void invalid() {
+    specifiers_.clear();
+    deliver(nullptr);
+  }
+
+  private:
+  static constexpr size_t RESERVED_TYPES = 4;
+
+  //! Composite type being built. The frames are recycled within a decoding
+  //! (``frames_[0, depth_)`` is the stack of the enclosing types)
+  struct frame_t {
+    OBJC_TYPES type = OBJC_TYPES::UNKNOWN;
+    std::set<OBJC_TYPE_SPECIFIERS> specifiers;
+    size_t dim = 0;
+    std::string_view name;
+    std::string_view field_name;
+    std::unique_ptr<Type> subtype;
+    std::vector<AttrTy> attributes;
+  };
+
+  //! Open a composite type which takes the pending specifiers
+  frame_t& push(OBJC_TYPES type) {
+    if (depth_ == frames_.size()) {
+      frames_.emplace_back();
+    }
+    frame_t& frame = frames_[depth_++];
+    frame.type = type;
+    frame.dim  = 0;
+    frame.name = {};
+    frame.field_name = {};
+    frame.subtype.reset();
+    frame.attributes.clear();
+    frame.specifiers.clear();
+    if (!specifiers_.empty()) {
+      frame.specifiers = std::move(specifiers_);
+      specifiers_.clear();
     }
+    return frame;
   }
-  const char c = *it++;
-  switch (c) {
-    case 'c': return std::make_unique<PrimitiveTy>(OBJC_TYPES::CHAR);
-    case 'i': return std::make_unique<PrimitiveTy>(OBJC_TYPES::INT);
-    case 's': return std::make_unique<PrimitiveTy>(OBJC_TYPES::SHORT);
-    case 'l': return std::make_unique<PrimitiveTy>(OBJC_TYPES::LONG);
-    case 'q': return std::make_unique<PrimitiveTy>(OBJC_TYPES::LONG_LONG);
-    case 'C': return std::make_unique<PrimitiveTy>(OBJC_TYPES::UNSIGNED_CHAR);
-    case 'I': return std::make_unique<PrimitiveTy>(OBJC_TYPES::UNSIGNED_INT);
-    case 'S': return std::make_unique<PrimitiveTy>(OBJC_TYPES::UNSIGNED_SHORT);
-    case 'L': return std::make_unique<PrimitiveTy>(OBJC_TYPES::UNSIGNED_LONG);
-    case 'Q': return std::make_unique<PrimitiveTy>(OBJC_TYPES::UNSIGNED_LONG_LONG);
-    case 'f': return std::make_unique<PrimitiveTy>(OBJC_TYPES::FLOAT);
-    case 'd': return std::make_unique<PrimitiveTy>(OBJC_TYPES::DOUBLE);
-    case 'B': return std::make_unique<PrimitiveTy>(OBJC_TYPES::BOOL);
-    case 'v': return std::make_unique<PrimitiveTy>(OBJC_TYPES::VOID);
-    case '*': return std::make_unique<PrimitiveTy>(OBJC_TYPES::CSTRING);
-    case '#': return std::make_unique<ClassTy>();
-    case ':': return std::make_unique<SelectorTy>();
-    case '[': return process_array(encoded, it);
-    case '{': return process_structure(encoded, it);
-    case '(': return process_union(encoded, it);
-    case 'b': return process_bitfield(encoded, it);
-    case '?': return std::make_unique<UnknownTy>();
-    case '^':
-      {
-        // Special case: ^? --> void*
-        if (it != std::end(encoded) && *it == '?') {
-          ++it;
-          return std::make_unique<PointerTy>(std::make_unique<PrimitiveTy>(OBJC_TYPES::VOID));
-        }
-        const size_t current_pos = get_pos(encoded, it);
-        std::unique_ptr<Type> ptr_type = process(encoded, it);
-        if (ptr_type == nullptr) {
-          ICDUMP_ERR("Can't resolve pointer type: {}", encoded.substr(current_pos, 3));
-          return nullptr;
-        }
-        return std::make_unique<PointerTy>(std::move(ptr_type));
 
-      }
-    case '@':
-      {
-        // Special case: @? --> void*
-        if (it != std::end(encoded) && *it == '?') {
-          ++it;
-          return std::make_unique<BlockTy>();
-        }
-        std::string name = read_opt_name(encoded, it);
-        return std::make_unique<ObjectTy>(name);
-      }
-    default:
-      {
-        size_t pos = get_pos(encoded, it);
-        ICDUMP_ERR("Unsupported type: {} ({})", c, encoded.substr(pos - 1));
-        return nullptr;
-      }
+  //! Specifiers which precede a leaf type (e.g. 'r' in ``r*``)
+  std::unique_ptr<Type> qualify(std::unique_ptr<Type> type) {
+    if (!specifiers_.empty()) {
+      type->specifiers = std::move(specifiers_);
+      specifiers_.clear();
+    }
+    return type;
   }
-  return nullptr;
-}
 
-OBJC_TYPE_SPECIFIERS process_specifier(const std::string& encoded, std::string::const_iterator& it) {
-  if (it == std::end(encoded)) {
-    return OBJC_TYPE_SPECIFIERS::UNKNOWN;
+  std::unique_ptr<Type> qualify(std::unique_ptr<Type> type, frame_t& frame) {
+    if (!frame.specifiers.empty()) {
+      type->specifiers = std::move(frame.specifiers);
+    }
+    return type;
   }
-  const char c = *it;
-  switch (c) {
-    case 'r': ++it; return OBJC_TYPE_SPECIFIERS::CONST;
-    case 'n': ++it; return OBJC_TYPE_SPECIFIERS::IN;
-    case 'N': ++it; return OBJC_TYPE_SPECIFIERS::IN_OUT;
-    case 'o': ++it; return OBJC_TYPE_SPECIFIERS::OUT;
-    case 'O': ++it; return OBJC_TYPE_SPECIFIERS::BY_COPY;
-    case 'R': ++it; return OBJC_TYPE_SPECIFIERS::BY_REF;
-    case 'V': ++it; return OBJC_TYPE_SPECIFIERS::ONE_WAY;
-    case 'A': ++it; return OBJC_TYPE_SPECIFIERS::ATOMIC;
-    case 'j': ++it; return OBJC_TYPE_SPECIFIERS::COMPLEX;
-    default:        return OBJC_TYPE_SPECIFIERS::UNKNOWN;
+
+  //! The frame stays valid until the next push()
+  frame_t& pop() {
+    return frames_[--depth_];
   }
 
+  //! Give a decoded type (nullptr if it is invalid) to the enclosing type
+  void deliver(std::unique_ptr<Type> type) {
+    if (depth_ == 0) {
+      current_ = std::move(type);
+      return;
+    }
+    frame_t& frame = frames_[depth_ - 1];
+    if (frame.type == OBJC_TYPES::STRUCT || frame.type == OBJC_TYPES::UNION) {
+      frame.attributes.emplace_back(std::string(frame.field_name), std::move(type));
+      return;
+    }
+    // For an array, the last element's type wins
+    frame.subtype = std::move(type);
+  }
+
+  std::vector<std::string_view>* encodings_ = nullptr;
+  std::set<OBJC_TYPE_SPECIFIERS> specifiers_;
+  std::vector<frame_t> frames_;
+  size_t depth_ = 0;
+  std::unique_ptr<Type> current_;
+  types_t types_;
+};
+
+types_t decode_type(const std::string& encoded, std::vector<std::string_view>* encodings) {
+  TypeBuilder& builder = TypeBuilder::get(encodings);
+  TypeWalker<TypeBuilder>(encoded, builder).walk();
+  return builder.take();
+}
 }
 
 types_t decode_type(const std::string& encoded) {
-  if (encoded.empty()) {
-    return {};
-  }
+  return decode_type(encoded, nullptr);
+}
 
-  size_t i = 0;
-  std::string::const_iterator it = std::begin(encoded);
-  const size_t encoded_size = encoded.size();
-  std::vector<std::unique_ptr<Type>> types;
-  while (it != std::end(encoded)) {
-    OBJC_TYPE_SPECIFIERS specifier = process_specifier(encoded, it);
-    std::unique_ptr<Type> decoded = process(encoded, it);
-    if (decoded) {
-      types.push_back(std::move(decoded));
-    }
-  }
-  return types;
+types_t decode_type(const std::string& encoded, std::vector<std::string_view>& encodings) {
+  return decode_type(encoded, &encodings);
 }
 
 const char* to_string(OBJC_TYPES type) {
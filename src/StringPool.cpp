@@ -0,0 +1,81 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+
+#include "StringPool.hpp"
+#include "log.hpp"
+
+namespace iCDump {
+
+StringPool::id_t StringPool::intern(std::string_view str) {
+  const auto [it, inserted] = lookup_.try_emplace(str, static_cast<id_t>(strings_.size()));
+  if (inserted) {
+    strings_.push_back(str);
+  }
+  return it->second;
+}
+
+void StringPool::add(uint64_t address, LIEF::span<const uint8_t> content) {
+  if (content.empty()) {
+    return;
+  }
+
+  section_t& sec = sections_.emplace_back();
+  sec.start = address;
+  sec.end   = address + content.size();
+  sec.starts.resize((content.size() + 63) / 64, 0);
+  sec.ranks.resize(sec.starts.size(), 0);
+
+  const auto* begin = reinterpret_cast<const char*>(content.data());
+  const size_t size = content.size();
+
+  // memchr is vectorized by the libc which makes the split
+  // bounded by the memory bandwidth
+  size_t offset = 0;
+  while (offset < size) {
+    const auto* end = static_cast<const char*>(std::memchr(begin + offset, '\0', size - offset));
+    if (end == nullptr) {
+      ICDUMP_DEBUG("String at 0x{:010x} is not terminated", address + offset);
+      break;
+    }
+    const size_t len = end - (begin + offset);
+    sec.starts[offset / 64] |= uint64_t(1) << (offset % 64);
+    sec.ids.push_back(intern({begin + offset, len}));
+    offset += len + 1;
+  }
+
+  uint32_t count = 0;
+  for (size_t i = 0; i < sec.starts.size(); ++i) {
+    sec.ranks[i] = count;
+    count += __builtin_popcountll(sec.starts[i]);
+  }
+}
+
+StringPool::id_t StringPool::find(uint64_t address) const {
+  for (const section_t& sec : sections_) {
+    if (address < sec.start || address >= sec.end) {
+      continue;
+    }
+    const uint64_t offset = address - sec.start;
+    const uint64_t word = sec.starts[offset / 64];
+    const uint64_t bit  = uint64_t(1) << (offset % 64);
+    if ((word & bit) == 0) {
+      return NO_ID;
+    }
+    return sec.ids[sec.ranks[offset / 64] + __builtin_popcountll(word & (bit - 1))];
+  }
+  return NO_ID;
+}
+}
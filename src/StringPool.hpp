@@ -0,0 +1,80 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_STRING_POOL_H_
+#define ICDUMP_STRING_POOL_H_
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <LIEF/span.hpp>
+
+#include "iCDump/NonCopyable.hpp"
+
+namespace iCDump {
+
+//! Index of the C-string sections of an image (__objc_methname,
+//! __objc_classname, __objc_methtype, __cstring).
+//!
+//! Each section is split once and its strings are deduplicated such as two
+//! strings with the same content share the same id (which can be used for
+//! equality). Resolving the string located at a given address is then O(1).
+//!
+//! The strings are views on the section's content. Once built, the pool
+//! is read-only and it can be used concurrently.
+class StringPool : protected NonCopyable {
+  public:
+  using id_t = uint32_t;
+  static constexpr id_t NO_ID = static_cast<id_t>(-1);
+
+  StringPool() = default;
+
+  //! Index the NUL-terminated strings of the section located at the given
+  //! virtual address. A trailing string which is not terminated is ignored.
+  void add(uint64_t address, LIEF::span<const uint8_t> content);
+
+  //! Id of the string starting at the given address or NO_ID if the address
+  //! is not the beginning of a string of an indexed section
+  id_t find(uint64_t address) const;
+
+  inline std::string_view get(id_t id) const {
+    return strings_[id];
+  }
+
+  //! Number of unique strings
+  inline size_t size() const {
+    return strings_.size();
+  }
+
+  private:
+  //! Strings of a section. The string starts are stored in a bitmap
+  //! (one bit per byte) along with the number of strings that precede
+  //! each word, so that the index of a string is a popcount away.
+  struct section_t {
+    uint64_t start = 0;
+    uint64_t end   = 0;
+    std::vector<uint64_t> starts;
+    std::vector<uint32_t> ranks;
+    std::vector<id_t> ids;
+  };
+
+  id_t intern(std::string_view str);
+
+  std::vector<section_t> sections_;
+  std::vector<std::string_view> strings_;
+  std::unordered_map<std::string_view, id_t> lookup_;
+};
+}
+#endif
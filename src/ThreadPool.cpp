@@ -0,0 +1,125 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ThreadPool.hpp"
+
+namespace iCDump {
+
+// Queue index of the current thread if it is a worker of ``current_pool``
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+size_t ThreadPool::default_concurrency() {
+  const size_t nb = std::thread::hardware_concurrency();
+  return nb > 0 ? nb : 1;
+}
+
+ThreadPool::ThreadPool(size_t nb_threads) {
+  if (nb_threads == 0) {
+    nb_threads = default_concurrency();
+  }
+  queues_.reserve(nb_threads);
+  for (size_t i = 0; i < nb_threads; ++i) {
+    queues_.push_back(std::make_unique<queue_t>());
+  }
+
+  workers_.reserve(nb_threads);
+  for (size_t i = 0; i < nb_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::worker, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (std::thread& th : workers_) {
+    th.join();
+  }
+}
+
+void ThreadPool::enqueue(task_t task) {
+  const size_t idx = current_pool == this ? current_queue :
+                     next_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  pending_.fetch_add(1);
+  {
+    // Published under the lock so that a worker going to sleep can't miss it
+    std::lock_guard lock(mutex_);
+    queued_.fetch_add(1);
+  }
+  {
+    queue_t& queue = *queues_[idx];
+    std::lock_guard lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  task_cv_.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock lock(mutex_);
+  done_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+bool ThreadPool::pop(size_t idx, task_t& task) {
+  queue_t& queue = *queues_[idx];
+  std::lock_guard lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::steal(size_t idx, task_t& task) {
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    queue_t& queue = *queues_[(idx + i) % queues_.size()];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::worker(size_t idx) {
+  current_pool  = this;
+  current_queue = idx;
+  while (true) {
+    task_t task;
+    if (!pop(idx, task) && !steal(idx, task)) {
+      std::unique_lock lock(mutex_);
+      if (stop_ && queued_ == 0) {
+        return;
+      }
+      task_cv_.wait(lock, [this] { return stop_ || queued_ > 0; });
+      // The task might have been taken by another worker meanwhile
+      continue;
+    }
+    queued_.fetch_sub(1);
+
+    task();
+
+    if (pending_.fetch_sub(1) == 1) {
+      std::lock_guard lock(mutex_);
+      done_cv_.notify_all();
+    }
+  }
+}
+}
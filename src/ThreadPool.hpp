@@ -0,0 +1,77 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_THREAD_POOL_H_
+#define ICDUMP_THREAD_POOL_H_
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "iCDump/NonCopyable.hpp"
+
+namespace iCDump {
+
+//! Fixed-size pool of worker threads with one task queue per worker.
+//!
+//! Tasks enqueued by a worker are pushed on its own queue (and processed
+//! LIFO) while tasks enqueued from outside are distributed round-robin.
+//! Idle workers steal the oldest tasks of the other queues so that a long
+//! task does not hold back the tasks queued behind it.
+class ThreadPool : protected NonCopyable {
+  public:
+  using task_t = std::function<void()>;
+
+  //! If nb_threads is 0, use the number of hardware threads
+  ThreadPool(size_t nb_threads = 0);
+  ~ThreadPool();
+
+  void enqueue(task_t task);
+
+  //! Block until all the enqueued tasks are completed
+  void wait();
+
+  inline size_t size() const {
+    return workers_.size();
+  }
+
+  static size_t default_concurrency();
+
+  private:
+  struct queue_t {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  void worker(size_t idx);
+  bool pop(size_t idx, task_t& task);
+  bool steal(size_t idx, task_t& task);
+
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<queue_t>> queues_;
+
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  std::atomic<size_t> queued_{0};
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> next_{0};
+  bool stop_ = false;
+};
+}
+#endif
@@ -0,0 +1,226 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+
+#include "iCDump/config.hpp"
+#include "ZipArchive.hpp"
+#include "MemoryMap.hpp"
+#include "log.hpp"
+
+#ifdef ICDUMP_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+namespace iCDump {
+
+static constexpr uint32_t EOCD_SIG         = 0x06054b50;
+static constexpr uint32_t CENTRAL_DIR_SIG  = 0x02014b50;
+static constexpr uint32_t LOCAL_HEADER_SIG = 0x04034b50;
+
+static constexpr size_t EOCD_SIZE         = 22;
+static constexpr size_t CENTRAL_DIR_SIZE  = 46;
+static constexpr size_t LOCAL_HEADER_SIZE = 30;
+static constexpr size_t MAX_COMMENT_SIZE  = 0xffff;
+
+static constexpr uint16_t FLAG_ENCRYPTED = 1 << 0;
+
+// Best compression ratio that deflate can achieve (RFC 1951 max-length runs)
+static constexpr uint64_t MAX_DEFLATE_RATIO = 1032;
+
+template<class T>
+inline T read_le(LIEF::span<const uint8_t> raw, uint64_t offset) {
+  T value = 0;
+  std::memcpy(&value, raw.data() + offset, sizeof(T));
+  return value;
+}
+
+#ifdef ICDUMP_ZLIB_SUPPORT
+// Inflate the raw deflate stream ``in`` until ``out`` is full
+static bool inflate_raw(LIEF::span<const uint8_t> in, LIEF::span<uint8_t> out) {
+  z_stream strm;
+  std::memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, -MAX_WBITS) != Z_OK) {
+    return false;
+  }
+  strm.next_in   = const_cast<Bytef*>(in.data());
+  strm.avail_in  = static_cast<uInt>(in.size());
+  strm.next_out  = out.data();
+  strm.avail_out = static_cast<uInt>(out.size());
+
+  int ret = Z_OK;
+  while (ret == Z_OK && strm.avail_out > 0) {
+    ret = inflate(&strm, Z_NO_FLUSH);
+  }
+  inflateEnd(&strm);
+  return strm.avail_out == 0 && (ret == Z_OK || ret == Z_STREAM_END || ret == Z_BUF_ERROR);
+}
+#else
+static bool inflate_raw(LIEF::span<const uint8_t>, LIEF::span<uint8_t>) {
+  ICDUMP_ERR("iCDump is not compiled with zlib: can't inflate the entry");
+  return false;
+}
+#endif
+
+ZipArchive::ZipArchive(std::unique_ptr<MemoryMap> mapping) :
+  mapping_{std::move(mapping)}
+{}
+
+ZipArchive::~ZipArchive() = default;
+
+std::unique_ptr<ZipArchive> ZipArchive::open(const std::string& path) {
+  std::unique_ptr<MemoryMap> mapping = MemoryMap::open(path);
+  if (!mapping) {
+    return nullptr;
+  }
+  std::unique_ptr<ZipArchive> archive(new ZipArchive(std::move(mapping)));
+  if (!archive->parse_central_directory()) {
+    ICDUMP_ERR("{} is not a valid zip archive", path);
+    return nullptr;
+  }
+  return archive;
+}
+
+bool ZipArchive::parse_central_directory() {
+  LIEF::span<const uint8_t> raw = mapping_->content();
+  if (raw.size() < EOCD_SIZE) {
+    return false;
+  }
+
+  // The End Of Central Directory record is followed by an optional comment
+  const uint64_t lower = raw.size() > EOCD_SIZE + MAX_COMMENT_SIZE ?
+                         raw.size() - EOCD_SIZE - MAX_COMMENT_SIZE : 0;
+  uint64_t eocd = raw.size() - EOCD_SIZE;
+  while (read_le<uint32_t>(raw, eocd) != EOCD_SIG) {
+    if (eocd == lower) {
+      ICDUMP_ERR("Can't find the end of central directory");
+      return false;
+    }
+    --eocd;
+  }
+
+  const uint16_t nb_entries = read_le<uint16_t>(raw, eocd + 10);
+  const uint32_t cd_size    = read_le<uint32_t>(raw, eocd + 12);
+  const uint32_t cd_offset  = read_le<uint32_t>(raw, eocd + 16);
+
+  if (nb_entries == 0xffff || cd_offset == 0xffffffff) {
+    ICDUMP_ERR("Zip64 archives are not supported");
+    return false;
+  }
+
+  if (cd_offset > raw.size() || raw.size() - cd_offset < cd_size) {
+    ICDUMP_ERR("The central directory is out of bounds");
+    return false;
+  }
+
+  entries_.reserve(nb_entries);
+  uint64_t offset = cd_offset;
+  const uint64_t end = cd_offset + cd_size;
+  for (size_t i = 0; i < nb_entries; ++i) {
+    if (end - offset < CENTRAL_DIR_SIZE || read_le<uint32_t>(raw, offset) != CENTRAL_DIR_SIG) {
+      ICDUMP_ERR("Central directory entry #{} is corrupted", i);
+      return false;
+    }
+    const uint16_t name_len    = read_le<uint16_t>(raw, offset + 28);
+    const uint16_t extra_len   = read_le<uint16_t>(raw, offset + 30);
+    const uint16_t comment_len = read_le<uint16_t>(raw, offset + 32);
+    if (end - offset - CENTRAL_DIR_SIZE < name_len) {
+      ICDUMP_ERR("Central directory entry #{} is corrupted", i);
+      return false;
+    }
+
+    entry_t& entry = entries_.emplace_back();
+    entry.flags               = read_le<uint16_t>(raw, offset + 8);
+    entry.method              = read_le<uint16_t>(raw, offset + 10);
+    entry.compressed_size     = read_le<uint32_t>(raw, offset + 20);
+    entry.uncompressed_size   = read_le<uint32_t>(raw, offset + 24);
+    entry.local_header_offset = read_le<uint32_t>(raw, offset + 42);
+    entry.name.assign(reinterpret_cast<const char*>(raw.data() + offset + CENTRAL_DIR_SIZE),
+                      name_len);
+
+    offset += CENTRAL_DIR_SIZE + name_len + extra_len + comment_len;
+  }
+  return true;
+}
+
+LIEF::span<const uint8_t> ZipArchive::raw_data(const entry_t& entry) const {
+  LIEF::span<const uint8_t> raw = mapping_->content();
+  const uint64_t offset = entry.local_header_offset;
+  if (offset > raw.size() || raw.size() - offset < LOCAL_HEADER_SIZE ||
+      read_le<uint32_t>(raw, offset) != LOCAL_HEADER_SIG)
+  {
+    ICDUMP_ERR("Corrupted local header for {}", entry.name);
+    return {};
+  }
+
+  // The name and the extra field can differ from the central directory
+  const uint16_t name_len  = read_le<uint16_t>(raw, offset + 26);
+  const uint16_t extra_len = read_le<uint16_t>(raw, offset + 28);
+  const uint64_t data_offset = offset + LOCAL_HEADER_SIZE + name_len + extra_len;
+  if (data_offset > raw.size() || raw.size() - data_offset < entry.compressed_size) {
+    ICDUMP_ERR("The data of {} are out of bounds", entry.name);
+    return {};
+  }
+  return raw.subspan(data_offset, entry.compressed_size);
+}
+
+bool ZipArchive::peek(const entry_t& entry, LIEF::span<uint8_t> out) const {
+  if (entry.flags & FLAG_ENCRYPTED || out.size() > entry.uncompressed_size) {
+    return false;
+  }
+
+  LIEF::span<const uint8_t> data = raw_data(entry);
+  if (data.empty() && entry.compressed_size > 0) {
+    return false;
+  }
+
+  switch (entry.method) {
+    case METHOD_STORED:
+      {
+        if (entry.compressed_size != entry.uncompressed_size || out.size() > data.size()) {
+          ICDUMP_ERR("{}: inconsistent sizes for a stored entry", entry.name);
+          return false;
+        }
+        if (!out.empty()) {
+          std::memcpy(out.data(), data.data(), out.size());
+        }
+        return true;
+      }
+    case METHOD_DEFLATED:
+      {
+        return inflate_raw(data, out);
+      }
+    default:
+      {
+        ICDUMP_WARN("{}: compression method {} is not supported", entry.name, entry.method);
+        return false;
+      }
+  }
+  return false;
+}
+
+bool ZipArchive::extract(const entry_t& entry, std::vector<uint8_t>& out) const {
+  // The uncompressed size comes from the (untrusted) central directory:
+  // check it against the compressed data before allocating
+  const uint64_t max_size = entry.method == METHOD_STORED ?
+                            entry.compressed_size : entry.compressed_size * MAX_DEFLATE_RATIO;
+  if (entry.uncompressed_size > max_size) {
+    ICDUMP_ERR("{}: uncompressed size 0x{:x} is not consistent with the compressed data",
+               entry.name, entry.uncompressed_size);
+    return false;
+  }
+  out.resize(entry.uncompressed_size);
+  return peek(entry, out);
+}
+}
@@ -0,0 +1,75 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ICDUMP_ZIP_ARCHIVE_H_
+#define ICDUMP_ZIP_ARCHIVE_H_
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <LIEF/span.hpp>
+
+#include "iCDump/NonCopyable.hpp"
+
+namespace iCDump {
+class MemoryMap;
+
+//! Read-only access to the entries of a (memory-mapped) zip archive (e.g. an IPA)
+//! Deflated entries are inflated in memory, stored entries are accessed in place.
+class ZipArchive : protected NonCopyable {
+  public:
+  static constexpr uint16_t METHOD_STORED   = 0;
+  static constexpr uint16_t METHOD_DEFLATED = 8;
+
+  struct entry_t {
+    std::string name;
+    uint16_t flags  = 0;
+    uint16_t method = 0;
+    uint64_t compressed_size     = 0;
+    uint64_t uncompressed_size   = 0;
+    uint64_t local_header_offset = 0;
+
+    inline bool is_directory() const {
+      return !name.empty() && name.back() == '/';
+    }
+  };
+
+  using entries_t = std::vector<entry_t>;
+
+  static std::unique_ptr<ZipArchive> open(const std::string& path);
+
+  ~ZipArchive();
+
+  inline const entries_t& entries() const {
+    return entries_;
+  }
+
+  //! Raw (i.e. possibly compressed) data of the entry
+  LIEF::span<const uint8_t> raw_data(const entry_t& entry) const;
+
+  //! Decompress the first ``out.size()`` bytes of the entry
+  bool peek(const entry_t& entry, LIEF::span<uint8_t> out) const;
+
+  //! Decompress the whole entry
+  bool extract(const entry_t& entry, std::vector<uint8_t>& out) const;
+
+  private:
+  ZipArchive(std::unique_ptr<MemoryMap> mapping);
+  bool parse_central_directory();
+
+  std::unique_ptr<MemoryMap> mapping_;
+  entries_t entries_;
+};
+}
+#endif
@@ -15,7 +15,10 @@
 #include "iCDump/iCDump.hpp"
 #include "iCDump/ObjC.hpp"
 #include "log.hpp"
-#include "MachOStream.hpp"
+#include "MachOImage.hpp"
+#include "MemoryMap.hpp"
+#include "ThreadPool.hpp"
+#include "ZipArchive.hpp"
 
 #include "LIEF/MachO.hpp"
 
@@ -23,28 +26,319 @@ using namespace LIEF::MachO;
 
 namespace iCDump {
 
+static constexpr uint32_t CPU_SUBTYPE_MASK  = 0xff000000;
+static constexpr uint32_t CPU_SUBTYPE_ARM64E = 2;
+
+static ARCH arch_from_cpu(uint32_t cpu_type, uint32_t cpu_subtype) {
+  switch (cpu_type) {
+    case MachOImage::CPU_TYPE_ARM64:
+      return (cpu_subtype & ~CPU_SUBTYPE_MASK) == CPU_SUBTYPE_ARM64E ?
+             ARCH::AARCH64E : ARCH::AARCH64;
+    case MachOImage::CPU_TYPE_ARM:    return ARCH::ARM;
+    case MachOImage::CPU_TYPE_X86_64: return ARCH::X86_64;
+    case MachOImage::CPU_TYPE_X86:    return ARCH::X86;
+    default:                          return ARCH::AUTO;
+  }
+}
+
 namespace ObjC {
-std::unique_ptr<Metadata> parse(const std::string& file_path, ARCH arch) {
-  static const ParserConfig PARSER_CONFIG = {
-    .parse_dyld_exports = true, .parse_dyld_bindings = true, .parse_dyld_rebases = false
-  };
+static constexpr size_t NO_SLICE = static_cast<size_t>(-1);
+
+using storage_t = ObjC::Parser::storage_t;
+
+//! Return the index of the slice that matches the given arch
+static size_t select_slice(const std::vector<ARCH>& archs, ARCH arch) {
+  if (arch != ARCH::AUTO) {
+    for (size_t i = 0; i < archs.size(); ++i) {
+      if (archs[i] == arch) {
+        return i;
+      }
+    }
+    return NO_SLICE;
+  }
+
+  for (size_t i = 0; i < archs.size(); ++i) {
+    if (archs[i] == ARCH::AARCH64 || archs[i] == ARCH::AARCH64E) {
+      return i;
+    }
+  }
+
+  for (size_t i = 0; i < archs.size(); ++i) {
+    if (archs[i] == ARCH::X86_64) {
+      return i;
+    }
+  }
+  return NO_SLICE;
+}
+
+static const ParserConfig PARSER_CONFIG = {
+  .parse_dyld_exports = true, .parse_dyld_bindings = true, .parse_dyld_rebases = false
+};
 
+static std::unique_ptr<FatBinary> load_full(const std::string& file_path) {
   auto fat_bin = LIEF::MachO::Parser::parse(file_path, PARSER_CONFIG);
   if (!fat_bin || fat_bin->empty()) {
     ICDUMP_ERR("Can't parse {}", file_path);
     return nullptr;
   }
-  // Look for the best architecture according to the arch parameter
-  if (auto arm64_bin  = fat_bin->take(CPU_TYPES::CPU_TYPE_ARM64)) {
-    return ObjC::Parser::parse(*arm64_bin);
+  return fat_bin;
+}
+
+static std::unique_ptr<FatBinary> load_full(span<const uint8_t> buffer) {
+  // LIEF needs to own a copy of the buffer
+  std::vector<uint8_t> raw(buffer.begin(), buffer.end());
+  auto fat_bin = LIEF::MachO::Parser::parse(std::move(raw), PARSER_CONFIG);
+  if (!fat_bin || fat_bin->empty()) {
+    ICDUMP_ERR("Can't parse the given buffer");
+    return nullptr;
+  }
+  return fat_bin;
+}
+
+static std::vector<ARCH> get_archs(const FatBinary& fat_bin) {
+  std::vector<ARCH> archs;
+  for (size_t i = 0; i < fat_bin.size(); ++i) {
+    const Binary& bin = *fat_bin.at(i);
+    archs.push_back(arch_from_cpu(static_cast<uint32_t>(bin.header().cpu_type()),
+                                  bin.header().cpu_subtype()));
+  }
+  return archs;
+}
+
+static std::vector<ARCH> get_archs(const MachOImage::slices_t& slices) {
+  std::vector<ARCH> archs;
+  for (const MachOImage::slice_t& slice : slices) {
+    archs.push_back(arch_from_cpu(slice.cpu_type, slice.cpu_subtype));
+  }
+  return archs;
+}
+
+//! ``storage`` owns the slice's content. It can be null if the
+//! content is owned by the user.
+static std::unique_ptr<Metadata> parse(const MachOImage::slice_t& slice, size_t nb_threads,
+                                       storage_t storage, LOAD_MODE mode)
+{
+  std::unique_ptr<MachOImage> image = MachOImage::parse(slice);
+  if (!image) {
+    ICDUMP_ERR("Can't parse the load commands");
+    return nullptr;
+  }
+  if (mode == LOAD_MODE::LAZY) {
+    return ObjC::Parser::parse_lazy(std::move(image), nb_threads, std::move(storage));
+  }
+  return ObjC::Parser::parse(*image, nb_threads, std::move(storage));
+}
+
+static std::unique_ptr<Metadata> parse_full(std::unique_ptr<FatBinary> fat_bin, ARCH arch,
+                                            size_t nb_threads)
+{
+  if (!fat_bin) {
+    return nullptr;
+  }
+
+  const size_t idx = select_slice(get_archs(*fat_bin), arch);
+  if (idx == NO_SLICE) {
+    ICDUMP_ERR("Can't find a supported architecture");
+    return nullptr;
+  }
+  return ObjC::Parser::parse(*fat_bin->at(idx), nb_threads);
+}
+
+static std::unique_ptr<Metadata> parse_metadata_only(LIEF::span<const uint8_t> raw, ARCH arch,
+                                                     size_t nb_threads, storage_t storage,
+                                                     LOAD_MODE mode)
+{
+  MachOImage::slices_t slices = MachOImage::slices(raw);
+  if (slices.empty()) {
+    return nullptr;
+  }
+
+  const size_t idx = select_slice(get_archs(slices), arch);
+  if (idx == NO_SLICE) {
+    ICDUMP_ERR("Can't find a supported architecture");
+    return nullptr;
+  }
+  return parse(slices[idx], nb_threads, std::move(storage), mode);
+}
+
+static slices_metadata_t parse_all(const FatBinary* fat_bin, const MachOImage::slices_t& slices,
+                                   size_t nb_threads, const storage_t& storage, LOAD_MODE mode)
+{
+  const std::vector<ARCH> archs = fat_bin != nullptr ? get_archs(*fat_bin) :
+                                                       get_archs(slices);
+  if (archs.empty()) {
+    return {};
+  }
+
+  std::vector<std::unique_ptr<Metadata>> results(archs.size());
+  {
+    if (nb_threads == 0) {
+      nb_threads = ThreadPool::default_concurrency();
+    }
+    ThreadPool pool(std::min(nb_threads, archs.size()));
+    for (size_t i = 0; i < archs.size(); ++i) {
+      if (archs[i] == ARCH::AUTO) {
+        ICDUMP_WARN("Slice #{} has an unsupported architecture", i);
+        continue;
+      }
+      pool.enqueue([&, i] {
+        results[i] = fat_bin != nullptr ? ObjC::Parser::parse(*fat_bin->at(i)) :
+                                          parse(slices[i], 1, storage, mode);
+      });
+    }
+    pool.wait();
+  }
+
+  slices_metadata_t metadata;
+  for (size_t i = 0; i < archs.size(); ++i) {
+    if (results[i] == nullptr) {
+      continue;
+    }
+    metadata.emplace_back(archs[i], std::move(results[i]));
+  }
+  return metadata;
+}
+
+std::unique_ptr<Metadata> parse(const std::string& file_path, ARCH arch, LOAD_MODE mode,
+                                size_t nb_threads)
+{
+  if (mode == LOAD_MODE::FULL) {
+    return parse_full(load_full(file_path), arch, nb_threads);
+  }
+
+  // The mapping is owned by the Metadata as its strings point into it
+  std::shared_ptr<MemoryMap> mapping = MemoryMap::open(file_path);
+  if (!mapping) {
+    return nullptr;
+  }
+  return parse_metadata_only(mapping->content(), arch, nb_threads, mapping, mode);
+}
+
+std::unique_ptr<Metadata> parse(span<const uint8_t> buffer, ARCH arch, LOAD_MODE mode,
+                                size_t nb_threads, storage_t owner)
+{
+  if (mode == LOAD_MODE::FULL) {
+    return parse_full(load_full(buffer), arch, nb_threads);
   }
+  return parse_metadata_only({buffer.data(), buffer.size()}, arch, nb_threads,
+                             std::move(owner), mode);
+}
 
-  if (auto x86_64_bin = fat_bin->take(CPU_TYPES::CPU_TYPE_X86_64)) {
-    return ObjC::Parser::parse(*x86_64_bin);
+slices_metadata_t parse_all(const std::string& file_path, LOAD_MODE mode, size_t nb_threads) {
+  if (mode == LOAD_MODE::FULL) {
+    std::unique_ptr<FatBinary> fat_bin = load_full(file_path);
+    if (!fat_bin) {
+      return {};
+    }
+    return parse_all(fat_bin.get(), {}, nb_threads, nullptr, mode);
   }
 
-  ICDUMP_ERR("Can't find a supported architecture");
-  return nullptr;
+  // Shared by the Metadata of all the slices
+  std::shared_ptr<MemoryMap> mapping = MemoryMap::open(file_path);
+  if (!mapping) {
+    return {};
+  }
+  return parse_all(nullptr, MachOImage::slices(mapping->content()), nb_threads, mapping, mode);
+}
+
+slices_metadata_t parse_all(span<const uint8_t> buffer, LOAD_MODE mode, size_t nb_threads,
+                            storage_t owner)
+{
+  if (mode == LOAD_MODE::FULL) {
+    std::unique_ptr<FatBinary> fat_bin = load_full(buffer);
+    if (!fat_bin) {
+      return {};
+    }
+    return parse_all(fat_bin.get(), {}, nb_threads, nullptr, mode);
+  }
+  return parse_all(nullptr, MachOImage::slices({buffer.data(), buffer.size()}), nb_threads,
+                   owner, mode);
+}
+
+//! Only consider the content of the application bundle (Payload/<name>.app/...)
+static bool is_bundle_entry(const ZipArchive::entry_t& entry) {
+  static constexpr size_t MIN_SIZE = 0x20; // sizeof(mach_header_64)
+  return !entry.is_directory() && entry.uncompressed_size >= MIN_SIZE &&
+         entry.name.rfind("Payload/", 0) == 0 &&
+         entry.name.find(".app/") != std::string::npos;
+}
+
+static std::unique_ptr<Metadata> parse_entry(const std::shared_ptr<ZipArchive>& archive,
+                                             const ZipArchive::entry_t& entry,
+                                             ARCH arch, LOAD_MODE mode)
+{
+  // Only inflate the magic to filter out the resources
+  uint8_t magic[sizeof(uint32_t)] = {0};
+  if (!archive->peek(entry, {magic, sizeof(magic)}) ||
+      !MachOImage::is_macho({magic, sizeof(magic)}))
+  {
+    return nullptr;
+  }
+
+  ICDUMP_DEBUG("Processing {}", entry.name);
+  if (entry.method == ZipArchive::METHOD_STORED) {
+    LIEF::span<const uint8_t> raw = archive->raw_data(entry);
+    if (mode == LOAD_MODE::FULL) {
+      return parse(span<const uint8_t>(raw.data(), raw.size()), arch, mode);
+    }
+    return parse_metadata_only(raw, arch, 1, archive, mode);
+  }
+
+  auto buffer = std::make_shared<std::vector<uint8_t>>();
+  if (!archive->extract(entry, *buffer)) {
+    ICDUMP_ERR("Can't extract {}", entry.name);
+    return nullptr;
+  }
+  if (mode == LOAD_MODE::FULL) {
+    return parse(span<const uint8_t>(*buffer), arch, mode);
+  }
+  const LIEF::span<const uint8_t> raw(buffer->data(), buffer->size());
+  return parse_metadata_only(raw, arch, 1, std::move(buffer), mode);
+}
+
+ipa_metadata_t parse_ipa(const std::string& ipa_path, ARCH arch, LOAD_MODE mode,
+                         size_t nb_threads)
+{
+  // The (stored) entries are referenced by the Metadata
+  std::shared_ptr<ZipArchive> archive = ZipArchive::open(ipa_path);
+  if (!archive) {
+    return {};
+  }
+
+  std::vector<const ZipArchive::entry_t*> entries;
+  for (const ZipArchive::entry_t& entry : archive->entries()) {
+    if (is_bundle_entry(entry)) {
+      entries.push_back(&entry);
+    }
+  }
+
+  if (entries.empty()) {
+    ICDUMP_ERR("Can't find the application bundle in {}", ipa_path);
+    return {};
+  }
+
+  std::vector<std::unique_ptr<Metadata>> results(entries.size());
+  {
+    if (nb_threads == 0) {
+      nb_threads = ThreadPool::default_concurrency();
+    }
+    ThreadPool pool(std::min(nb_threads, entries.size()));
+    for (size_t i = 0; i < entries.size(); ++i) {
+      pool.enqueue([&, i] {
+        results[i] = parse_entry(archive, *entries[i], arch, mode);
+      });
+    }
+    pool.wait();
+  }
+
+  ipa_metadata_t metadata;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (results[i] == nullptr) {
+      continue;
+    }
+    metadata.emplace_back(entries[i]->name, std::move(results[i]));
+  }
+  return metadata;
 }
 }
 }
@@ -12,6 +12,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <mutex>
+
 #include "log.hpp"
 
 #include "spdlog/spdlog.h"
@@ -72,10 +74,12 @@ Logger::Logger(void) {
 }
 
 Logger& Logger::instance() {
-  if (instance_ == nullptr) {
+  // The slices (and the binaries) can be parsed from different threads
+  static std::once_flag flag;
+  std::call_once(flag, [] {
     instance_ = new Logger{};
     std::atexit(destroy);
-  }
+  });
   return *instance_;
 }
 
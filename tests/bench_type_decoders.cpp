@@ -0,0 +1,104 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <iCDump/Arena.hpp>
+#include <iCDump/Logging.hpp>
+#include <iCDump/ObjC/TypeNode.hpp>
+#include <iCDump/ObjC/TypeVisitor.hpp>
+#include <iCDump/ObjC/TypesEncoding.hpp>
+
+// Throughput of the type decoders on the kinds of encodings found in the
+// ObjC metadata. Each measure is the best of several rounds in ns/encoding.
+
+using namespace iCDump;
+using namespace iCDump::ObjC;
+using clock_type = std::chrono::steady_clock;
+
+struct corpus_t {
+  const char* name;
+  std::vector<const char*> encodings;
+};
+
+static const corpus_t CORPORA[] = {
+  {"prototypes", {"v16@0:8", "@24@0:8@16", "B32@0:8@16@24", "q24@0:8q16", "v20@0:8B16"}},
+  {"objects",    {"@\"NSString\"16@0:8", "v24@0:8@?16", "v32@0:8o^@16n^i24", "r*16@0:8"}},
+  {"records",    {"{CGRect={CGPoint=dd}{CGSize=dd}}16@0:8", "{?=\"a\"i\"b\"[4c]}",
+                  "(?=\"i\"i\"f\"f)", "{Bits=\"x\"b3\"y\"b12}", "^{__CFString=}"}},
+};
+
+static constexpr size_t NB_COPIES = 20000;
+
+//! Best time (ns/encoding) of ``nb_rounds`` runs of ``func`` over the corpus
+template<class F>
+static double measure(const std::vector<std::string>& corpus, size_t nb_rounds, const F& func) {
+  double best = 0;
+  for (size_t i = 0; i < nb_rounds; ++i) {
+    const auto start = clock_type::now();
+    for (const std::string& encoding : corpus) {
+      func(encoding);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+    const double ns = elapsed.count() / corpus.size();
+    best = i == 0 ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const size_t nb_rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+  set_log_level(LOG_LEVEL::ERR);
+
+  TypeVisitor visitor;
+  size_t nb_types = 0;
+
+  Arena arena;
+  printf("%-12s %12s %12s %12s %12s\n", "corpus", "walk_type", "decode_type",
+         "nodes_cold", "nodes_warm");
+  for (const corpus_t& corpus : CORPORA) {
+    std::vector<std::string> encodings;
+    encodings.reserve(NB_COPIES * corpus.encodings.size());
+    for (size_t i = 0; i < NB_COPIES; ++i) {
+      encodings.insert(encodings.end(), corpus.encodings.begin(), corpus.encodings.end());
+    }
+
+    // Parsing only: lower bound of the decoders built on the same grammar
+    const double walk = measure(encodings, nb_rounds, [&] (const std::string& encoding) {
+      walk_type(encoding, visitor);
+    });
+
+    const double tree = measure(encodings, nb_rounds, [&] (const std::string& encoding) {
+      nb_types += decode_type(encoding).size();
+    });
+    // A new arena for each encoding: its first block is allocated
+    const double cold = measure(encodings, nb_rounds, [&] (const std::string& encoding) {
+      Arena local;
+      nb_types += decode_nodes(encoding, local) != nullptr;
+    });
+
+    // The arena is reset, the nodes reuse the same block
+    const double warm = measure(encodings, nb_rounds, [&] (const std::string& encoding) {
+      arena.reset();
+      nb_types += decode_nodes(encoding, arena) != nullptr;
+    });
+    printf("%-12s %12.1f %12.1f %12.1f %12.1f\n", corpus.name, walk, tree, cold, warm);
+  }
+  return nb_types > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
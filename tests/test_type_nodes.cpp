@@ -0,0 +1,134 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <iCDump/Arena.hpp>
+#include <iCDump/Logging.hpp>
+#include <iCDump/ObjC/TypeNode.hpp>
+#include <iCDump/ObjC/TypesEncoding.hpp>
+
+// Differential test: decode_nodes() must produce the same trees as decode_type()
+
+using namespace iCDump;
+using namespace iCDump::ObjC;
+
+static const char* ENCODINGS[] = {
+  // Method prototypes
+  "v16@0:8", "@24@0:8@16", "B32@0:8@16@24", "v20@0:8B16", "q24@0:8q16", "r*16@0:8",
+  "^v16@0:8", "^?16@0:8", "v24@0:8@?16", "Vv16@0:8", "v32@0:8o^@16n^i24",
+  "@\"NSString\"16@0:8", "v24@0:8@\"<NSCopying>\"16",
+  // Records, arrays and bit-fields
+  "{CGRect={CGPoint=dd}{CGSize=dd}}16@0:8", "v48@0:8{CGRect={CGPoint=dd}{CGSize=dd}}16",
+  "{?=\"a\"i\"b\"[4c]}", "(?=\"i\"i\"f\"f)", "[12^{Foo}]", "{Bits=\"x\"b3\"y\"b12}",
+  "{vector<int, std::allocator<int> >=^i^i{__compressed_pair<int *, std::allocator<int> >=^i}}",
+  "^{__CFString=}", "{X}", "^^{X}", "(U=ic)", "r^{?=[2d]}", "[3[4{P=ii}]]", "{?}", "(?)",
+  "{S=\"a\"^{S}\"b\"(U=\"x\"b2\"y\"[3^?])}", "{A=\"n\"i12}", "[3i5]",
+  // Specifiers
+  "jf", "Ai", "Ar^Ni", "rr8", "r",
+  // Invalid or truncated encodings
+  "", "8", "x16@0:8", "{Unterminated=ii", "[5i", "b", "^", "@\"", "{A=\"f\"}", "^x", "[2x]",
+  "{A=x}", "(U=i", "^^^", "[]", "^[2i", "@?@?",
+};
+
+static type_specifiers_mask_t specifiers_mask(const Type& type) {
+  type_specifiers_mask_t mask = 0;
+  for (OBJC_TYPE_SPECIFIERS spec : type.specifiers) {
+    mask |= specifier_bit(spec);
+  }
+  return mask;
+}
+
+static bool same_fields(const std::vector<AttrTy>& attributes, const FieldNode* fields);
+
+static bool same_type(const Type* type, const TypeNode* node) {
+  if (type == nullptr || node == nullptr) {
+    return type == nullptr && node == nullptr;
+  }
+  if (type->type != node->type || specifiers_mask(*type) != node->specifiers) {
+    return false;
+  }
+  switch (type->type) {
+    case OBJC_TYPES::OBJECT:
+      return static_cast<const ObjectTy*>(type)->name == node->name;
+    case OBJC_TYPES::BIT_FIELD:
+      return static_cast<const BitFieldTy*>(type)->size == node->size;
+    case OBJC_TYPES::POINTER:
+      return same_type(static_cast<const PointerTy*>(type)->subtype.get(), node->subtype);
+    case OBJC_TYPES::ARRAY:
+      {
+        const auto* array = static_cast<const ArrayTy*>(type);
+        return array->dim == node->size && same_type(array->subtype.get(), node->subtype);
+      }
+    case OBJC_TYPES::STRUCT:
+      {
+        const auto* record = static_cast<const StructTy*>(type);
+        return record->name == node->name && same_fields(record->attributes, node->fields);
+      }
+    case OBJC_TYPES::UNION:
+      {
+        const auto* record = static_cast<const UnionTy*>(type);
+        return record->name == node->name && same_fields(record->attributes, node->fields);
+      }
+    default:
+      return true;
+  }
+}
+
+static bool same_fields(const std::vector<AttrTy>& attributes, const FieldNode* fields) {
+  for (const AttrTy& attribute : attributes) {
+    if (fields == nullptr || attribute.name != fields->name ||
+        !same_type(attribute.type.get(), fields->type))
+    {
+      return false;
+    }
+    fields = fields->next;
+  }
+  return fields == nullptr;
+}
+
+int main() {
+  // Invalid encodings are expected
+  disable_log();
+
+  size_t nb_failed = 0;
+  Arena arena;
+  for (const char* encoding : ENCODINGS) {
+    const types_t types = decode_type(encoding);
+    // Also check that a reset arena can be reused
+    arena.reset();
+    const TypeNode* node = decode_nodes(encoding, arena);
+
+    bool same = true;
+    for (const std::unique_ptr<Type>& type : types) {
+      if (!same_type(type.get(), node)) {
+        same = false;
+        break;
+      }
+      node = node->next;
+    }
+    if (!same || node != nullptr) {
+      fprintf(stderr, "Mismatch for '%s'\n", encoding);
+      ++nb_failed;
+    }
+  }
+
+  printf("%zu/%zu encodings\n", std::size(ENCODINGS) - nb_failed, std::size(ENCODINGS));
+  return nb_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,164 @@
+/* Copyright 2023 R. Thomas
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <iCDump/Batch.hpp>
+#include <iCDump/Logging.hpp>
+
+using namespace iCDump;
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+    "Usage: %s [options] <file|directory>...\n"
+    "\n"
+    "Dump the ObjC metadata of a corpus of Mach-O files\n"
+    "\n"
+    "Options:\n"
+    "  -o, --output <dir>       Output directory for the <name>_objc.h files\n"
+    "  -l, --list <file>        Read the inputs from a file (one per line)\n"
+    "  -j, --threads <n>        Number of threads (default: hardware threads)\n"
+    "  --max-inflight <n>       Maximum number of binaries in flight (default: 2 * threads)\n"
+    "  --arch <arch>            aarch64, aarch64e, arm, x86_64, x86 (default: auto)\n"
+    "  --full-load              Fully parse the Mach-O files with LIEF (slower)\n"
+    "  --skip-protocols         Skip ObjC protocols definition\n"
+    "  --summary <file>         Write a per-file TSV report\n"
+    "  -q, --quiet              Only log errors and do not print the progress\n",
+    argv0);
+}
+
+static bool parse_arch(const std::string& name, ARCH& arch) {
+  static const std::pair<const char*, ARCH> ARCHS[] = {
+    {"auto",     ARCH::AUTO},
+    {"aarch64",  ARCH::AARCH64},
+    {"aarch64e", ARCH::AARCH64E},
+    {"arm",      ARCH::ARM},
+    {"x86_64",   ARCH::X86_64},
+    {"x86",      ARCH::X86},
+  };
+  for (const auto& [str, value] : ARCHS) {
+    if (name == str) {
+      arch = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+static const char* to_string(ObjC::batch_entry_t::STATUS status) {
+  switch (status) {
+    case ObjC::batch_entry_t::STATUS::OK:        return "OK";
+    case ObjC::batch_entry_t::STATUS::NOT_MACHO: return "NOT_MACHO";
+    case ObjC::batch_entry_t::STATUS::ERROR:     return "ERROR";
+  }
+  return "?";
+}
+
+static bool write_summary(const std::string& path, const ObjC::batch_summary_t& summary) {
+  std::ofstream ofs(path);
+  if (!ofs) {
+    return false;
+  }
+  ofs << "path\tstatus\tsize\tclasses\tprotocols\telapsed_ms\toutput\n";
+  for (const ObjC::batch_entry_t& entry : summary.entries) {
+    ofs << entry.path << '\t' << to_string(entry.status) << '\t' << entry.size << '\t'
+        << entry.nb_classes << '\t' << entry.nb_protocols << '\t'
+        << entry.elapsed.count() << '\t' << entry.output_path << '\n';
+  }
+  return static_cast<bool>(ofs);
+}
+
+int main(int argc, char** argv) {
+  ObjC::batch_config_t config;
+  std::vector<std::string> inputs;
+  std::string summary_path;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if ((arg == "-o" || arg == "--output") && has_value) {
+      config.output_dir = argv[++i];
+    } else if ((arg == "-l" || arg == "--list") && has_value) {
+      std::ifstream ifs(argv[++i]);
+      if (!ifs) {
+        fprintf(stderr, "Can't read %s\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+      for (std::string line; std::getline(ifs, line);) {
+        if (!line.empty()) {
+          inputs.push_back(std::move(line));
+        }
+      }
+    } else if ((arg == "-j" || arg == "--threads") && has_value) {
+      config.nb_threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--max-inflight" && has_value) {
+      config.max_inflight = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--arch" && has_value) {
+      if (!parse_arch(argv[++i], config.arch)) {
+        fprintf(stderr, "Unknown architecture: %s\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+    } else if (arg == "--full-load") {
+      config.mode = LOAD_MODE::FULL;
+    } else if (arg == "--skip-protocols") {
+      config.skip_protocols = true;
+    } else if (arg == "--summary" && has_value) {
+      summary_path = argv[++i];
+    } else if (arg == "-q" || arg == "--quiet") {
+      quiet = true;
+    } else if (arg == "-h" || arg == "--help") {
+      usage(argv[0]);
+      return EXIT_SUCCESS;
+    } else if (!arg.empty() && arg[0] == '-') {
+      fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+
+  if (inputs.empty()) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (quiet) {
+    set_log_level(LOG_LEVEL::ERR);
+  }
+
+  std::atomic<size_t> nb_done{0};
+  const ObjC::batch_summary_t summary = ObjC::dump_batch(inputs, config,
+    [&] (const ObjC::batch_entry_t& entry) {
+      const size_t idx = ++nb_done;
+      if (!quiet) {
+        fprintf(stderr, "[%zu] %s %s (%lld ms)\n", idx, to_string(entry.status),
+                entry.path.c_str(), static_cast<long long>(entry.elapsed.count()));
+      }
+    });
+
+  if (!summary_path.empty() && !write_summary(summary_path, summary)) {
+    fprintf(stderr, "Can't write %s\n", summary_path.c_str());
+  }
+
+  printf("%s\n", summary.to_string().c_str());
+  return summary.nb_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}